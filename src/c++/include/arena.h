@@ -0,0 +1,60 @@
+/**
+ * @file arena.h
+ * @brief Per-level scratch memory arenas for the mining loop
+ *
+ * Every level of the joinless algorithm builds and throws away scratch buffers
+ * while filtering clique instances (match flags, per-thread row buffers).
+ * A LevelArena hands out one monotonic buffer per thread so these allocations
+ * become pointer bumps, and the whole level is freed in one call.
+ */
+
+#pragma once
+#include <memory>
+#include <memory_resource>
+#include <vector>
+
+/**
+ * @brief Per-thread monotonic memory arena released wholesale at the end of a level
+ *
+ * Each OpenMP thread owns its own std::pmr::monotonic_buffer_resource, so threads
+ * never contend on a lock. Deallocation is a no-op; memory is only returned to the
+ * system when release() is called.
+ */
+class LevelArena {
+private:
+    std::vector<std::unique_ptr<std::pmr::monotonic_buffer_resource>> threadResources;  ///< One resource per thread
+
+public:
+    /**
+     * @brief Construct an arena with one buffer resource per OpenMP thread
+     *
+     * @param initialBytes Size of the first upstream chunk requested by each thread
+     */
+    explicit LevelArena(size_t initialBytes = 1 << 20);
+
+    LevelArena(const LevelArena&) = delete;
+    LevelArena& operator=(const LevelArena&) = delete;
+
+    /**
+     * @brief Get the memory resource owned by a given thread
+     *
+     * @param threadId OpenMP thread number (0 for the master thread)
+     * @return std::pmr::memory_resource* Resource to allocate from
+     */
+    std::pmr::memory_resource* resource(int threadId);
+
+    /**
+     * @brief Get the memory resource of the calling OpenMP thread
+     *
+     * @return std::pmr::memory_resource* Resource to allocate from
+     */
+    std::pmr::memory_resource* local();
+
+    /**
+     * @brief Release every allocation made from this arena
+     *
+     * All containers allocated from the arena must be destroyed or emptied
+     * before calling this.
+     */
+    void release();
+};
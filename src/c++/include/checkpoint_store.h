@@ -0,0 +1,143 @@
+/**
+ * @file checkpoint_store.h
+ * @brief On-disk checkpoints of level-wise mining and of the neighbor graph
+ */
+
+#pragma once
+#include "types.h"
+#include "pattern.h"
+#include "mapped_file.h"
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Mining state after one completed level, as read back from a checkpoint
+ */
+struct LevelState {
+    uint32_t level = 0;                ///< Last completed pattern size k
+    std::vector<Pattern> prevalent;    ///< Prevalent patterns of sizes 2..k, in mining order
+    std::vector<Pattern> candidates;   ///< Candidates of level k; clique tuples refer to them by index
+    size_t tupleWidth = 0;             ///< Words per clique tuple (k + 1), 0 if the level stored none
+    Span<uint32_t> tuples;             ///< Clique tuples (pattern ID, member feature indices), in the mapping
+    std::shared_ptr<const MappedFile> file;  ///< Mapping `tuples` points into
+};
+
+/**
+ * @brief CheckpointStore class writing and reading checkpoints in one directory
+ *
+ * Two files are kept: the neighbor graph (the star neighbor lists of every
+ * instance, in CSR form), which depends on the dataset and the distance only, and
+ * the state after the last completed level of JoinlessMiner::mineColocations().
+ * Each carries the fingerprint of what produced it and is ignored when the
+ * fingerprint does not match the current run.
+ *
+ * Both files share one layout: a fixed header holding the offset and length of
+ * every array, followed by the arrays as raw native-endian words aligned to 8
+ * bytes, so a reader maps the file and uses the arrays in place (see
+ * MappedFile). Files are written under a temporary name and renamed, so an
+ * interrupted write leaves the previous checkpoint intact.
+ */
+class CheckpointStore {
+public:
+    /**
+     * @brief Producer of clique tuples for saveLevel()
+     *
+     * Fills up to `capacity` tuples at `block` and returns how many were written;
+     * returns 0 once every tuple has been produced.
+     */
+    using TupleSource = std::function<size_t(uint32_t* block, size_t capacity)>;
+
+private:
+    std::string directory;  ///< Directory holding the checkpoint files
+
+    std::string levelPath() const;
+    std::string graphPath() const;
+
+public:
+    /**
+     * @brief Constructor to select the checkpoint directory
+     *
+     * @param dir Directory for checkpoint files (created on first save)
+     */
+    explicit CheckpointStore(const std::string& dir);
+
+    /**
+     * @brief Fingerprint a dataset together with the neighbor distance
+     *
+     * Hashes the type, ID and coordinates of every instance in order, so a
+     * different file, sample or spatial ordering gives a different fingerprint.
+     *
+     * @param instances Vector of all spatial instances
+     * @param distance Neighbor distance threshold
+     * @return uint64_t Fingerprint of the neighbor graph
+     */
+    static uint64_t fingerprint(const std::vector<SpatialInstance>& instances, double distance);
+
+    /**
+     * @brief Extend a fingerprint with one more parameter
+     *
+     * @param base Fingerprint so far
+     * @param value Parameter value (e.g. the minimum prevalence)
+     * @return uint64_t Combined fingerprint
+     */
+    static uint64_t fingerprint(uint64_t base, double value);
+
+    /**
+     * @brief Extend a fingerprint with one more textual parameter
+     *
+     * @param base Fingerprint so far
+     * @param value Parameter value (e.g. the feature constraints)
+     * @return uint64_t Combined fingerprint
+     */
+    static uint64_t fingerprint(uint64_t base, const std::string& value);
+
+    /**
+     * @brief Save the star neighbor lists of every instance
+     *
+     * @param key Fingerprint of the dataset and distance
+     * @param offsets List boundaries in `neighbors` (size instances + 1)
+     * @param neighbors Star neighbor positions of every instance, list after list
+     */
+    void saveNeighborGraph(uint64_t key, const std::vector<size_t>& offsets,
+                           const std::vector<uint32_t>& neighbors) const;
+
+    /**
+     * @brief Load the star neighbor lists saved for the same dataset and distance
+     *
+     * @param key Fingerprint of the dataset and distance
+     * @param numInstances Number of instances of the dataset
+     * @param offsets Output list boundaries
+     * @param neighbors Output star neighbor positions
+     * @return bool False if no graph with this fingerprint is stored
+     */
+    bool loadNeighborGraph(uint64_t key, size_t numInstances, std::vector<size_t>& offsets,
+                           std::vector<uint32_t>& neighbors) const;
+
+    /**
+     * @brief Save the state after a completed level, replacing the previous one
+     *
+     * @param key Fingerprint of the run (dataset, distance and prevalence)
+     * @param level Pattern size k of the completed level
+     * @param prevalent Prevalent patterns found so far
+     * @param candidates Candidates of the level
+     * @param tupleWidth Words per clique tuple (0 if the level keeps no clique table)
+     * @param tupleCount Number of clique tuples
+     * @param source Producer of the clique tuples
+     */
+    void saveLevel(uint64_t key, uint32_t level, const std::vector<Pattern>& prevalent,
+                   const std::vector<Pattern>& candidates, size_t tupleWidth, size_t tupleCount,
+                   const TupleSource& source) const;
+
+    /**
+     * @brief Map the state of the last completed level
+     *
+     * @param key Fingerprint of the run
+     * @param state Output state; its tuples stay mapped while `state.file` lives
+     * @return bool False if no level with this fingerprint is stored
+     */
+    bool loadLevel(uint64_t key, LevelState& state) const;
+};
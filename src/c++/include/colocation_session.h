@@ -0,0 +1,107 @@
+/**
+ * @file colocation_session.h
+ * @brief Embeddable mining session: instances, neighbor graph and mining in one handle
+ */
+
+#pragma once
+#include "types.h"
+#include "neighborhood_mgr.h"
+#include "spatial_order.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Options of one ColocationSession::mine() call
+ */
+struct MiningOptions {
+    double minPrevalence = 0.6;        ///< Minimum prevalence threshold (0.0 to 1.0)
+    std::string strategy = "levelwise";  ///< "levelwise" or "depthfirst"
+    size_t memoryBudget = 0;           ///< Level-wise: budget for level instance tables in bytes (0 = unlimited)
+    std::string spillDir;              ///< Directory for runs spilled beyond the budget (empty = system temp)
+};
+
+/**
+ * @brief ColocationSession class holding a dataset and its neighbor graph for repeated mining
+ *
+ * The library entry point for embedding the miner in-process: instances come
+ * from memory (columnar arrays or SpatialInstance values) rather than files, the
+ * star neighborhoods are built once per distance, and any number of mining runs
+ * with different options reuse them. mine() only reads the session, so several
+ * threads may mine one session concurrently once its graph is built.
+ */
+class ColocationSession {
+private:
+    std::vector<SpatialInstance> instances;          ///< Instances, with feature codes assigned
+    std::unique_ptr<NeighborhoodMgr> neighborhoods;  ///< Star neighborhoods, nullptr until built
+    double distance = 0.0;                           ///< Distance the neighborhoods were built for
+
+public:
+    ColocationSession() = default;
+    ColocationSession(const ColocationSession&) = delete;
+    ColocationSession& operator=(const ColocationSession&) = delete;
+
+    /**
+     * @brief Load instances from columnar arrays, replacing any loaded before
+     *
+     * Instance IDs are built as in DataLoader::load_csv(): the feature name
+     * followed by the instance number.
+     *
+     * @param featureCodes Per instance: index into `featureNames`
+     * @param x Per instance: x coordinate
+     * @param y Per instance: y coordinate
+     * @param instanceNumbers Per instance: instance number, or nullptr to number
+     *        each feature's instances 1, 2, ... in input order
+     * @param count Number of instances
+     * @param featureNames Name of each feature index
+     * @param order Optional space-filling-curve ordering of the instances
+     * @throws std::invalid_argument If a feature index is out of range
+     */
+    void loadInstances(const int32_t* featureCodes, const double* x, const double* y,
+                       const int64_t* instanceNumbers, size_t count,
+                       const std::vector<std::string>& featureNames,
+                       SpatialOrder order = SpatialOrder::None);
+
+    /**
+     * @brief Load instances given as values, replacing any loaded before
+     *
+     * @param data Instances (type, id and coordinates are used)
+     * @param order Optional space-filling-curve ordering of the instances
+     */
+    void loadInstances(std::vector<SpatialInstance> data, SpatialOrder order = SpatialOrder::None);
+
+    /**
+     * @brief Build the star neighborhoods for a distance, replacing the previous ones
+     *
+     * @param distanceThreshold Maximum distance for two instances to be considered neighbors
+     */
+    void buildNeighborGraph(double distanceThreshold);
+
+    /**
+     * @brief Mine prevalent colocation patterns over the current neighbor graph
+     *
+     * @param options Mining options
+     * @return std::vector<Colocation> Prevalent patterns, by size and then by name
+     * @throws std::logic_error If no neighbor graph has been built
+     * @throws std::invalid_argument If an option is out of range
+     */
+    std::vector<Colocation> mine(const MiningOptions& options) const;
+
+    /**
+     * @brief Exact participation index of patterns over the current neighbor graph
+     *
+     * @param patterns Colocation patterns, e.g. as returned by mine()
+     * @return std::vector<double> Participation index of each pattern
+     * @throws std::logic_error If no neighbor graph has been built
+     * @throws std::invalid_argument If a pattern names a feature not in the dataset
+     */
+    std::vector<double> participationIndices(const std::vector<Colocation>& patterns) const;
+
+    /** @brief Loaded instances, in memory order */
+    const std::vector<SpatialInstance>& getInstances() const { return instances; }
+
+    /** @brief Distance of the current neighbor graph (0 if none is built) */
+    double neighborDistance() const { return distance; }
+};
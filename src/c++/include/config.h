@@ -10,6 +10,7 @@
 #include <fstream>
 #include <string>
 #include <sstream>
+#include <vector>
 
 /**
  * @brief Configuration structure for application settings
@@ -28,6 +29,26 @@ struct AppConfig {
     double minCondProb;        ///< Minimum conditional probability for rules (0.0 to 1.0)
     double percentageData;
 
+    // Performance Settings
+    std::string spatialOrder;  ///< Load-time instance ordering: "none", "morton" or "hilbert"
+    std::string miningStrategy; ///< Mining engine: "levelwise", "depthfirst" or "partitioned"
+    int partitionTiles;        ///< Partitioned mining: tiles along each axis
+    int partitionWorkers;      ///< Partitioned mining: number of worker processes
+    double maxMemoryMb;        ///< Level-wise mining: budget for level instance tables in MB (0 = unlimited)
+    std::string spillDir;      ///< Directory for runs spilled beyond the budget (empty = system temp)
+    std::string checkpointDir; ///< Level-wise mining: directory for level checkpoints (empty = none)
+    std::vector<std::string> includeFeatures; ///< Only mine patterns containing all of these features
+    std::vector<std::string> excludeFeatures; ///< Only mine patterns containing none of these features
+    std::string region;        ///< Only mine instances in "minX,minY,maxX,maxY" or a WKT POLYGON (empty = all)
+
+    // Streaming Settings
+    double streamWindow;       ///< Sliding window length for timestamped events (0 = batch mining)
+    double streamStep;         ///< Time the window advances by per update
+
+    // Server Settings
+    std::string serverSocket;  ///< Unix-domain socket to serve mining requests on (empty = mine once and exit)
+    int serverThreads;         ///< Server: requests served concurrently
+
     // System Settings
     bool debugMode;            ///< Enable debug output messages
 
@@ -44,6 +65,17 @@ struct AppConfig {
           minPrev(0.6),
           percentageData(1.0),
           minCondProb(0.5),
+          spatialOrder("none"),
+          miningStrategy("levelwise"),
+          partitionTiles(4),
+          partitionWorkers(4),
+          maxMemoryMb(0.0),
+          spillDir(""),
+          checkpointDir(""),
+          streamWindow(0.0),
+          streamStep(1.0),
+          serverSocket(""),
+          serverThreads(4),
           debugMode(false) {}
 };
 
@@ -63,6 +95,8 @@ public:
      * 
      * @param configPath Path to the configuration file
      * @return AppConfig Configuration object with loaded or default values
+     * @throws std::invalid_argument If stream_window is negative, stream_step is not positive,
+     *         or mining_strategy or spatial_order is unknown
      */
     static AppConfig load(const std::string& configPath);
 };
\ No newline at end of file
@@ -6,6 +6,7 @@
 #pragma once
 #include "types.h"
 #include "csv.hpp"
+#include "spatial_order.h"
 #include <string>
 #include <vector>
 
@@ -26,8 +27,25 @@ public:
      * - LocY: Y coordinate (double)
      * 
      * @param filepath Path to the CSV file
+     * @param percentage Fraction of each feature's instances to keep (sampled at random)
+     * @param order Optional space-filling-curve ordering applied after sampling
      * @return std::vector<SpatialInstance> Vector of loaded spatial instances
      * @note Instance IDs are generated as: FeatureType + InstanceNumber (e.g., "A1", "B2")
+     * @note Feature codes are assigned to the returned instances (see assignFeatureCodes())
      */
-    static std::vector<SpatialInstance> load_csv(const std::string& filepath, double percentage = 1.0);
+    static std::vector<SpatialInstance> load_csv(const std::string& filepath, double percentage = 1.0,
+                                                 SpatialOrder order = SpatialOrder::None);
+
+    /**
+     * @brief Load timestamped spatial events from a CSV file
+     *
+     * Expects the columns of load_csv() plus a numeric Timestamp (or Time) column.
+     * Instance IDs are built the same way, so an ID seen again later is a new
+     * observation of the same instance.
+     *
+     * @param filepath Path to the CSV file
+     * @return std::vector<SpatialEvent> Events sorted by timestamp (stable)
+     * @note Feature codes are not assigned; the streaming engine assigns its own
+     */
+    static std::vector<SpatialEvent> load_events(const std::string& filepath);
 };
\ No newline at end of file
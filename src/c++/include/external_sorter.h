@@ -0,0 +1,150 @@
+/**
+ * @file external_sorter.h
+ * @brief Sorting of packed integer tuples under a memory budget, spilling to disk
+ */
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * @brief ExternalSorter class sorting fixed-width uint32 tuples in bounded memory
+ *
+ * Tuples are buffered in memory until the buffer reaches its share of the budget;
+ * the buffer is then radix sorted and written to a run file in the spill
+ * directory. Runs are stored as compressed columnar chunks: each chunk holds a
+ * block of tuples column by column as variable-length integers, the first
+ * (sorted) column as deltas.
+ *
+ * Once finish() has been called, a Cursor streams every tuple in lexicographic
+ * order by merging the runs, reading one chunk of each at a time; finish() first
+ * merges runs in passes of kMaxFanIn, so that read buffer stays bounded. A sorter
+ * that never exceeded its budget never touches the disk. Run files are deleted
+ * with the sorter.
+ */
+class ExternalSorter {
+private:
+    /**
+     * @brief One sorted run on disk
+     */
+    struct Run {
+        std::string path;   ///< Run file
+        size_t tuples = 0;  ///< Number of tuples in the run
+    };
+
+    size_t width;                  ///< Words per tuple
+    size_t bufferTuples;           ///< Tuples buffered before a run is spilled
+    std::string spillDirectory;    ///< Directory of the run files
+    std::vector<uint32_t> buffer;  ///< Unsorted (or, after finish(), sorted) in-memory tuples
+    std::vector<Run> runs;         ///< Spilled runs
+    size_t total = 0;              ///< Number of tuples pushed
+    bool finished = false;         ///< True once finish() has been called
+
+    /**
+     * @brief Sort the buffer, write it as a new run and empty it
+     */
+    void spill();
+
+    /**
+     * @brief Merge runs [first, last) into one new run appended to `runs`
+     */
+    void mergeRuns(size_t first, size_t last);
+
+public:
+    static constexpr size_t kChunkTuples = 1 << 12;  ///< Tuples per compressed chunk
+    static constexpr size_t kMaxFanIn = 64;          ///< Most runs merged at once
+
+    /**
+     * @brief Merged, sorted stream over the runs and the in-memory tuples of a sorter
+     */
+    class Cursor {
+    private:
+        /**
+         * @brief Read position inside one source (a run file or the memory buffer)
+         */
+        struct Source {
+            std::unique_ptr<std::ifstream> file;  ///< Run file, nullptr for the memory buffer
+            std::vector<uint32_t> chunk;          ///< Decoded tuples of the current chunk
+            const uint32_t* data = nullptr;       ///< Tuples being read (chunk or memory buffer)
+            size_t count = 0;                     ///< Number of tuples at `data`
+            size_t position = 0;                  ///< Next tuple to read
+            size_t remaining = 0;                 ///< Tuples of the run not decoded yet
+        };
+
+        size_t width = 0;
+        std::vector<Source> sources;
+        std::vector<size_t> heap;  ///< Sources with tuples left, min-heap on their current tuple
+
+        /** @brief Decode the next chunk of a source; false once it is exhausted */
+        bool loadChunk(Source& source);
+
+        /** @brief Heap order: true if source a's current tuple is greater than b's */
+        bool greater(size_t a, size_t b) const;
+
+        friend class ExternalSorter;
+
+    public:
+        /** @brief True while a tuple is available */
+        bool valid() const { return !heap.empty(); }
+
+        /** @brief Current (smallest remaining) tuple, `width` words */
+        const uint32_t* tuple() const;
+
+        /** @brief Advance to the next tuple */
+        void next();
+    };
+
+private:
+    /**
+     * @brief Open a merged stream over runs [first, last), plus the memory buffer
+     *        when `last` is the final run
+     */
+    Cursor openRuns(size_t first, size_t last) const;
+
+public:
+    /**
+     * @brief Construct a sorter for tuples of a given width
+     *
+     * @param width Words per tuple
+     * @param budgetBytes Memory the in-memory buffer and its sort may use
+     * @param spillDir Directory for run files (empty: the system temporary directory)
+     */
+    ExternalSorter(size_t width, size_t budgetBytes, const std::string& spillDir);
+    ~ExternalSorter();
+
+    ExternalSorter(const ExternalSorter&) = delete;
+    ExternalSorter& operator=(const ExternalSorter&) = delete;
+
+    /**
+     * @brief Add one tuple (`width` words)
+     */
+    void push(const uint32_t* tuple);
+
+    /**
+     * @brief Sort the remaining buffered tuples; no tuple may be pushed afterwards
+     *
+     * If any run was spilled, the buffer is spilled too, so a finished sorter
+     * only holds memory when its tuples fit in the budget.
+     */
+    void finish();
+
+    /**
+     * @brief Open a sorted stream over all tuples (requires finish())
+     *
+     * The cursor reads the sorter's memory buffer, so the sorter must outlive it.
+     */
+    Cursor cursor() const;
+
+    /** @brief Words per tuple */
+    size_t tupleWidth() const { return width; }
+
+    /** @brief Number of tuples pushed */
+    size_t size() const { return total; }
+
+    /** @brief Number of runs spilled to disk */
+    size_t runCount() const { return runs.size(); }
+};
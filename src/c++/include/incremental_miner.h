@@ -0,0 +1,201 @@
+/**
+ * @file incremental_miner.h
+ * @brief Incremental colocation mining under instance insertions and deletions
+ */
+
+#pragma once
+#include "types.h"
+#include "pattern.h"
+#include <cstdint>
+#include <deque>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief Prevalence changes caused by one batch of updates
+ */
+struct MiningDelta {
+    std::vector<Colocation> gained;  ///< Patterns prevalent after the batch but not before
+    std::vector<Colocation> lost;    ///< Patterns prevalent before the batch but not after
+};
+
+/**
+ * @brief IncrementalMiner class keeping a colocation mining result up to date
+ *
+ * Unlike JoinlessMiner, which mines a fixed dataset from scratch, this engine keeps
+ * its whole state in memory between calls: a hashed grid of the live instances, the
+ * neighbor list of every instance (whose part with greater feature codes is the
+ * instance's star neighborhood), and the participation bitmaps of every candidate
+ * pattern of the last mining pass.
+ *
+ * A clique instance gained or lost through an inserted or deleted instance x
+ * contains x, so every other member is a neighbor of x. A batch therefore only
+ * rebuilds the neighbor lists around the changed instances, and only re-decides
+ * the participation of the changed instances and their neighbors in the patterns
+ * containing a changed feature. Candidate generation is then rerun level by level
+ * over the cached bitmaps; only candidates that were not tracked before are
+ * evaluated over the whole dataset.
+ *
+ * Deleted instances leave a tombstone in their storage slot (and feature index).
+ * Once tombstones outnumber the live instances, the slots are compacted: live
+ * instances are renumbered in their old order and the tracked bitmaps remapped,
+ * so the state stays proportional to the live instances under endless streams.
+ * A batch introducing a feature type that was never seen before changes the
+ * feature codes, and rebuilds the state.
+ */
+class IncrementalMiner {
+private:
+    double distanceThreshold;  ///< Distance threshold for neighbor determination
+    double minPrev;            ///< Minimum prevalence threshold
+
+    std::deque<SpatialInstance> instances;          ///< Instances by slot, live or deleted
+    std::vector<char> alive;                        ///< Per slot: false once the instance is deleted
+    std::vector<FeatureCode> slotFeature;           ///< Per slot: feature code of the instance
+    std::vector<std::vector<uint32_t>> adjacency;   ///< Per slot: neighbor slots, sorted by (feature, slot)
+    std::unordered_map<instanceID, uint32_t> slotById;          ///< Live instance ID -> slot
+    std::unordered_map<uint64_t, std::vector<uint32_t>> cells;  ///< Grid cell key -> live slots in the cell
+
+    std::vector<FeatureType> featureTypes;            ///< Sorted feature types; index i is feature code i
+    std::vector<std::vector<uint32_t>> featureSlots;  ///< Per feature: slot of each feature index
+    std::vector<size_t> featureSizes;                 ///< Per feature: number of live instances
+
+    std::unordered_map<Pattern, std::vector<ParticipationBitmap>, PatternHash> tracked;  ///< Candidate -> slot bitmaps
+    std::vector<Pattern> prevalent;  ///< Prevalent patterns, by size and then in sorted order
+
+    /**
+     * @brief Pack integer cell coordinates into a hash key
+     */
+    static uint64_t cellKey(int64_t cx, int64_t cy);
+
+    /**
+     * @brief Grid cell key of a position (cells have the distance threshold as side)
+     */
+    uint64_t cellOf(double x, double y) const;
+
+    /**
+     * @brief Check whether two live slots are neighbors (binary search in a's list)
+     */
+    bool areNeighbors(uint32_t a, uint32_t b) const;
+
+    /**
+     * @brief Add an instance to the grid, linking it with its live neighbors
+     *
+     * @param instance Instance to add (its feature code must already exist)
+     * @return uint32_t Slot of the new instance
+     */
+    uint32_t insertInstance(SpatialInstance instance);
+
+    /**
+     * @brief Remove a live instance from the grid and from its neighbors' lists
+     *
+     * @param slot Slot of the instance, which becomes a tombstone
+     */
+    void eraseInstance(uint32_t slot);
+
+    /**
+     * @brief Drop the tombstones, renumbering slots and feature indexes
+     *
+     * Renumbering keeps the relative order of the live slots, so neighbor lists
+     * stay sorted and only their entries are rewritten.
+     */
+    void compact();
+
+    /**
+     * @brief Search a clique instance of a pattern containing a given instance
+     *
+     * @param member Slot of the instance, whose feature belongs to the pattern
+     * @param pattern Feature codes of the pattern
+     * @param clique Output: slot of the member of each pattern feature, in pattern order
+     * @return bool True if the instance participates in the pattern
+     */
+    bool findClique(uint32_t member, const Pattern& pattern, uint32_t* clique) const;
+
+    /**
+     * @brief Extend a partial clique by one instance of each remaining feature
+     *
+     * @param member Instance every member must neighbor
+     * @param rest Features still to cover, in pattern order
+     * @param depth Number of features of `rest` already covered
+     * @param chosen Slots chosen for the covered features
+     * @return bool True if the clique was completed
+     */
+    bool extendClique(uint32_t member, const Pattern& rest, size_t depth, uint32_t* chosen) const;
+
+    /**
+     * @brief Compute the participation bitmaps of a pattern over the whole dataset
+     *
+     * @param pattern Feature codes of the pattern
+     * @return std::vector<ParticipationBitmap> One bitmap per slot, indexed by feature index
+     */
+    std::vector<ParticipationBitmap> evaluatePattern(const Pattern& pattern) const;
+
+    /**
+     * @brief Re-decide the participation of changed instances in a tracked pattern
+     *
+     * @param pattern Feature codes of the pattern
+     * @param slots Bitmaps of the pattern, updated in place
+     * @param affected Slots whose participation may have changed, live or deleted
+     */
+    void updatePattern(const Pattern& pattern, std::vector<ParticipationBitmap>& slots,
+                       const std::vector<uint32_t>& affected) const;
+
+    /**
+     * @brief Check a pattern's bitmaps against the live feature sizes
+     */
+    bool isPrevalent(const Pattern& pattern, const std::vector<ParticipationBitmap>& slots) const;
+
+    /**
+     * @brief Rerun candidate generation level by level over the tracked bitmaps
+     *
+     * Candidates that were already tracked keep their bitmaps, new ones are
+     * evaluated (in parallel), and patterns that stopped being candidates are
+     * dropped.
+     */
+    void refresh();
+
+    /**
+     * @brief Translate patterns of feature codes to feature names
+     */
+    std::vector<Colocation> decodePatterns(const std::vector<Pattern>& patterns) const;
+
+public:
+    /**
+     * @brief Constructor to initialize the engine with its mining parameters
+     *
+     * @param distThresh Maximum distance for two instances to be considered neighbors
+     * @param minPrevalence Minimum prevalence threshold (0.0 to 1.0)
+     */
+    IncrementalMiner(double distThresh, double minPrevalence);
+
+    /**
+     * @brief Index a dataset and mine it from scratch, replacing any previous state
+     *
+     * @param dataset Initial spatial instances (instance IDs must be unique)
+     */
+    void build(const std::vector<SpatialInstance>& dataset);
+
+    /**
+     * @brief Apply a batch of deletions and insertions and update the result
+     *
+     * Deletions are applied first. Deleting an unknown ID is ignored, and inserting
+     * an ID that is still live replaces (moves) that instance.
+     *
+     * @param inserted Instances to insert (feature codes are assigned here)
+     * @param deleted IDs of the instances to delete
+     * @return MiningDelta Patterns that gained or lost prevalence
+     */
+    MiningDelta applyBatch(const std::vector<SpatialInstance>& inserted,
+                           const std::vector<instanceID>& deleted);
+
+    /**
+     * @brief Current prevalent patterns, in the order mineColocations() reports them
+     *
+     * @return std::vector<Colocation> Prevalent colocation patterns
+     */
+    std::vector<Colocation> prevalentPatterns() const;
+
+    /**
+     * @brief Number of live instances
+     */
+    size_t size() const { return slotById.size(); }
+};
@@ -0,0 +1,169 @@
+/**
+ * @file joinless.h
+ * @brief C interface of the joinless colocation mining library
+ *
+ * A thin C ABI over ColocationSession for embedding the miner in services and
+ * for foreign-function bindings. Objects are opaque handles created and freed by
+ * the library. Functions returning int report JOINLESS_OK or an error code; the
+ * message of the calling thread's last error is available from
+ * joinless_last_error(). No function lets a C++ exception escape.
+ */
+
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(_WIN32) && defined(JOINLESS_SHARED)
+#  ifdef JOINLESS_BUILDING
+#    define JOINLESS_API __declspec(dllexport)
+#  else
+#    define JOINLESS_API __declspec(dllimport)
+#  endif
+#else
+#  define JOINLESS_API
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @brief Version of this interface, bumped on incompatible changes */
+#define JOINLESS_API_VERSION 1
+
+/* Status codes */
+#define JOINLESS_OK 0               /**< Success */
+#define JOINLESS_INVALID_ARGUMENT 1 /**< A handle or argument is invalid */
+#define JOINLESS_INVALID_STATE 2    /**< The call needs an earlier step (e.g. a neighbor graph) */
+#define JOINLESS_FAILED 3           /**< Mining failed (out of memory, I/O error, ...) */
+
+/* Mining strategies */
+#define JOINLESS_LEVELWISE 0        /**< All candidates of a level at once */
+#define JOINLESS_DEPTHFIRST 1       /**< One prefix class at a time */
+
+/* Instance orderings */
+#define JOINLESS_ORDER_NONE 0       /**< Keep the input order */
+#define JOINLESS_ORDER_MORTON 1     /**< Z-order curve */
+#define JOINLESS_ORDER_HILBERT 2    /**< Hilbert curve */
+
+/** @brief Dataset, neighbor graph and mining state (ColocationSession) */
+typedef struct joinless_session joinless_session;
+
+/** @brief Patterns returned by one mining run */
+typedef struct joinless_result joinless_result;
+
+/**
+ * @brief Options of joinless_session_mine()
+ *
+ * Initialize with joinless_options_init(); fields added in later versions go at
+ * the end, and `struct_size` tells the library which ones the caller knows.
+ */
+typedef struct joinless_options {
+    size_t struct_size;        /**< sizeof(joinless_options), set by joinless_options_init() */
+    double min_prevalence;     /**< Minimum prevalence threshold (0.0 to 1.0) */
+    int strategy;              /**< JOINLESS_LEVELWISE or JOINLESS_DEPTHFIRST */
+    size_t memory_budget;      /**< Level-wise: bytes for level instance tables (0 = unlimited) */
+    const char* spill_dir;     /**< Directory for spilled runs (NULL = system temp) */
+    int participation;         /**< Nonzero: also compute each pattern's exact participation index */
+} joinless_options;
+
+/** @brief Interface version of the loaded library (JOINLESS_API_VERSION it was built with) */
+JOINLESS_API int joinless_api_version(void);
+
+/** @brief Message of the calling thread's last failed call ("" if none) */
+JOINLESS_API const char* joinless_last_error(void);
+
+/** @brief Fill options with their defaults */
+JOINLESS_API void joinless_options_init(joinless_options* options);
+
+/** @brief Create an empty session; NULL on failure */
+JOINLESS_API joinless_session* joinless_session_create(void);
+
+/** @brief Free a session (NULL is ignored); results it produced stay valid */
+JOINLESS_API void joinless_session_free(joinless_session* session);
+
+/**
+ * @brief Load instances from columnar arrays, replacing the session's dataset
+ *
+ * The arrays are only read during the call.
+ *
+ * @param session Session
+ * @param feature_codes Per instance: index into `feature_names`
+ * @param x Per instance: x coordinate
+ * @param y Per instance: y coordinate
+ * @param instance_numbers Per instance: number used in its ID, or NULL to number
+ *        each feature's instances 1, 2, ... in input order
+ * @param count Number of instances
+ * @param feature_names Name of each feature index (UTF-8, NUL-terminated)
+ * @param num_features Number of feature names
+ * @param order JOINLESS_ORDER_* memory ordering of the instances
+ */
+JOINLESS_API int joinless_session_load(joinless_session* session,
+                                       const int32_t* feature_codes, const double* x, const double* y,
+                                       const int64_t* instance_numbers, size_t count,
+                                       const char* const* feature_names, size_t num_features,
+                                       int order);
+
+/** @brief Number of instances loaded in a session */
+JOINLESS_API size_t joinless_session_size(const joinless_session* session);
+
+/**
+ * @brief Build the star neighborhoods of the loaded instances for a distance
+ */
+JOINLESS_API int joinless_session_build_graph(joinless_session* session, double distance);
+
+/**
+ * @brief Mine prevalent colocation patterns over the session's neighbor graph
+ *
+ * @param session Session with a neighbor graph
+ * @param options Options, or NULL for the defaults
+ * @param result Output: result handle, to be freed with joinless_result_free()
+ */
+JOINLESS_API int joinless_session_mine(const joinless_session* session, const joinless_options* options,
+                                       joinless_result** result);
+
+/** @brief Number of patterns in a result */
+JOINLESS_API size_t joinless_result_count(const joinless_result* result);
+
+/** @brief Number of features of pattern `index` (0 if out of range) */
+JOINLESS_API size_t joinless_result_pattern_size(const joinless_result* result, size_t index);
+
+/**
+ * @brief Feature `slot` of pattern `index`, NULL if out of range
+ *
+ * The string is owned by the result.
+ */
+JOINLESS_API const char* joinless_result_feature(const joinless_result* result, size_t index, size_t slot);
+
+/**
+ * @brief Participation index of pattern `index`
+ *
+ * NaN if the index is out of range or the result was mined without
+ * joinless_options::participation.
+ */
+JOINLESS_API double joinless_result_participation(const joinless_result* result, size_t index);
+
+/** @brief Total number of features over all patterns of a result */
+JOINLESS_API size_t joinless_result_total_features(const joinless_result* result);
+
+/**
+ * @brief Copy a result into flat arrays (the layout of an Arrow list array)
+ *
+ * Pattern i consists of codes[offsets[i] .. offsets[i + 1]), where each code is
+ * the index of the feature in the `feature_names` passed to
+ * joinless_session_load().
+ *
+ * @param result Result
+ * @param offsets Output, joinless_result_count() + 1 entries
+ * @param codes Output, joinless_result_total_features() entries
+ * @param participation Output, joinless_result_count() entries, or NULL (NaN
+ *        entries if the result was mined without participation)
+ */
+JOINLESS_API int joinless_result_export(const joinless_result* result, int64_t* offsets, int32_t* codes,
+                                        double* participation);
+
+/** @brief Free a result (NULL is ignored) */
+JOINLESS_API void joinless_result_free(joinless_result* result);
+
+#ifdef __cplusplus
+}
+#endif
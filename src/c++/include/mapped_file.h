@@ -0,0 +1,61 @@
+/**
+ * @file mapped_file.h
+ * @brief Read-only memory mapping of a file
+ */
+
+#pragma once
+#include "types.h"
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/**
+ * @brief MappedFile class exposing the contents of a file as read-only memory
+ *
+ * On POSIX systems the file is mapped with mmap, so arrays stored in it are used
+ * in place and paged in on demand. On Windows the file is read into a buffer
+ * instead.
+ */
+class MappedFile {
+private:
+    const uint8_t* bytes = nullptr;  ///< First byte of the contents
+    size_t length = 0;               ///< Size of the file in bytes
+    std::vector<uint8_t> buffer;     ///< Contents read into memory where mapping is not used
+
+public:
+    /**
+     * @brief Map a file
+     *
+     * @param path File to map
+     * @throws std::runtime_error If the file cannot be opened or mapped
+     */
+    explicit MappedFile(const std::string& path);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    /** @brief First byte of the file */
+    const uint8_t* data() const { return bytes; }
+
+    /** @brief Size of the file in bytes */
+    size_t size() const { return length; }
+
+    /**
+     * @brief View an array stored in the file
+     *
+     * @param offset Byte offset of the first element (aligned for T)
+     * @param count Number of elements
+     * @return Span<T> View into the mapping, valid while the file stays mapped
+     * @throws std::runtime_error If the array does not lie inside the file
+     */
+    template <typename T>
+    Span<T> array(uint64_t offset, uint64_t count) const {
+        if (offset > length || count > (length - offset) / sizeof(T) || offset % alignof(T) != 0) {
+            throw std::runtime_error("Mapped file is truncated or corrupt");
+        }
+        return Span<T>{reinterpret_cast<const T*>(bytes + offset), static_cast<size_t>(count)};
+    }
+};
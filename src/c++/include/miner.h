@@ -9,8 +9,14 @@
 #pragma once
 #include "types.h"
 #include "neighborhood_mgr.h"
+#include "arena.h"
+#include "pattern.h"
+#include "pattern_registry.h"
+#include "external_sorter.h"
+#include "checkpoint_store.h"
 #include <vector>
 #include <map>
+#include <string>
 #include <functional>
 
 /**
@@ -33,6 +39,120 @@ private:
     double minPrev;                          ///< Minimum prevalence threshold
     NeighborhoodMgr* neighborhoodMgr;        ///< Pointer to neighborhood manager
     ProgressCallback progressCallback;        ///< Progress reporting callback
+    std::vector<FeatureType> featureTypes;   ///< Sorted feature types; index i is feature code i
+    std::vector<size_t> featureSizes;         ///< Number of instances of each feature code
+    std::vector<size_t> coreSizes;            ///< Per feature code: instances counted in prevalence (empty = all)
+    std::vector<size_t> countedSizes;         ///< Prevalence denominators of the current run
+    size_t memoryBudget = 0;                  ///< Budget for level instance storage in bytes (0 = unlimited)
+    std::string spillDirectory;               ///< Directory for spilled runs (empty = system temporary directory)
+    const CheckpointStore* checkpoints = nullptr;  ///< Where completed levels are saved (nullptr = no checkpoints)
+    uint64_t checkpointKey = 0;               ///< Fingerprint of the run, stored with each checkpoint
+    bool resumeRequested = false;             ///< Continue from a matching checkpoint instead of level 2
+    uint32_t resumedFrom = 0;                 ///< Level the last run resumed after (0 = started afresh)
+    std::vector<FeatureType> includeFeatures; ///< Features every mined pattern must contain
+    std::vector<FeatureType> excludeFeatures; ///< Features no mined pattern may contain
+    Pattern requiredCodes;                    ///< Codes of includeFeatures in the current run, ascending
+    std::vector<char> excludedCodes;          ///< Per feature code: true if excluded in the current run
+
+    /**
+     * @brief Set countedSizes for the current run from coreSizes, or to featureSizes
+     *
+     * @throws std::invalid_argument If coreSizes does not fit featureSizes
+     */
+    void resolveCountedSizes();
+
+    /**
+     * @brief Resolve the feature constraints against the feature codes of the current run
+     *
+     * Fills requiredCodes and excludedCodes from featureTypes.
+     *
+     * @return bool False if no pattern can satisfy the constraints (an included
+     *         feature is excluded or absent from the dataset)
+     */
+    bool resolveConstraints();
+
+    /**
+     * @brief Check a pattern of feature codes against the constraints of the current run
+     */
+    bool satisfiesConstraints(const Pattern& codes) const;
+
+    /**
+     * @brief Check whether patterns below a depth-first prefix can hold every required feature
+     *
+     * Patterns below a prefix add only features of its extensions, so each
+     * required feature the prefix lacks must be one of them.
+     *
+     * @param prefix Feature codes of the prefix, ascending
+     * @param extensions Features that may still be appended, ascending
+     * @param firstMissing Output: smallest required code the prefix lacks (SIZE_MAX if none)
+     * @return bool False if some required feature can no longer be added
+     */
+    bool requiredReachable(const Pattern& prefix, const std::vector<FeatureCode>& extensions,
+                           size_t& firstMissing) const;
+
+    /**
+     * @brief Generate the candidates of the next level of the constrained sublattice
+     *
+     * Every pattern holding the required features is those features plus a free
+     * part, and a pattern's free subsets (plus the required features) are its
+     * subsets that still satisfy the constraint, so Apriori-gen runs over the free
+     * parts alone: free parts sharing all but their last feature are joined, and
+     * candidates with a non-prevalent free subset are pruned. From the required
+     * features alone, every allowed feature is a one-feature extension.
+     *
+     * @param prevPrevalent Prevalent patterns of the current level, all holding requiredCodes
+     * @return std::vector<Pattern> Candidates one feature larger, in sorted order
+     */
+    std::vector<Pattern> generateConstrainedCandidates(const std::vector<Pattern>& prevPrevalent) const;
+
+    /**
+     * @brief Translate a pattern of feature names to feature codes
+     *
+     * @param pattern Colocation pattern (feature types)
+     * @return Pattern Feature codes, in the same order
+     */
+    Pattern encodePattern(const Colocation& pattern) const;
+
+    /**
+     * @brief Translate patterns of feature codes back to feature names
+     *
+     * @param patterns Patterns of feature codes
+     * @return std::vector<Colocation> The same patterns as feature types
+     */
+    std::vector<Colocation> decodePatterns(const std::vector<Pattern>& patterns) const;
+
+    /**
+     * @brief Index the star neighborhoods by the feature code of their centers
+     *
+     * @param starNeighborhoods Star neighborhoods grouped by center feature type
+     * @return Stars of each feature code (nullptr if the feature has none)
+     */
+    std::vector<const std::vector<StarNeighborhood>*> starsByFeatureCode(
+        const std::unordered_map<FeatureType, std::vector<StarNeighborhood>>& starNeighborhoods
+    ) const;
+
+    /**
+     * @brief Check whether every slot of a pattern has reached its participant threshold
+     *
+     * @param slots Participation bitmaps of the k slots
+     * @param need Participant thresholds of the k slots
+     * @param k Pattern size
+     * @return bool True if the pattern is prevalent
+     */
+    static bool thresholdsReached(const ParticipationBitmap* slots, const size_t* need, size_t k);
+
+    /**
+     * @brief Build the mask of features a star must contain to hold a pattern
+     *
+     * The center feature (codes[0]) is left out, since only stars of that feature
+     * are scanned for the pattern.
+     *
+     * @param codes Feature codes of the pattern, center feature first
+     * @param required Output mask of the non-center features
+     * @return bool False if some feature is not representable in a FeatureMask, in
+     *         which case stars must be checked through their group lists alone
+     */
+    static bool requiredFeatureMask(const Pattern& codes, FeatureMask& required);
 
     /**
      * @brief Filter star instances that match candidate patterns
@@ -40,13 +160,15 @@ private:
      * Examines star neighborhoods to find instances that match the candidate
      * colocation patterns. This is the first filtering step.
      * 
-     * @param candidates Vector of candidate colocation patterns to check
+     * @param registry Candidate patterns of the current level
      * @param starNeigh Pair of feature type and its star neighborhoods
-     * @return std::vector<ColocationInstance> Filtered instances matching candidates
+     * @param filteredInstances Flat table (width k) the matching instances and their
+     *        pattern IDs are appended to
      */
-    std::vector<ColocationInstance> filterStarInstances(
-        const std::vector<Colocation>& candidates,
-        const std::pair<FeatureType, std::vector<StarNeighborhood>>& starNeigh
+    void filterStarInstances(
+        const PatternRegistry& registry,
+        const std::pair<FeatureType, std::vector<StarNeighborhood>>& starNeigh,
+        InstanceTable& filteredInstances
     );
 
     /**
@@ -54,38 +176,322 @@ private:
      * 
      * Performs clique filtering to ensure all (k-1) subsets of a k-size pattern
      * exist in the previous level. Uses parallel processing for performance.
+     *
+     * A star instance is a clique if the instance without its center is a clique
+     * instance of the candidate's suffix pattern. Both sides are packed into
+     * integer tuples (pattern, member feature indices) -- a single 64-bit key
+     * when the fields fit -- radix sorted, and matched with a parallel linear
+     * merge join instead of a lookup structure.
      * 
-     * @param candidates Vector of candidate patterns
+     * @param registry Candidate patterns of the current level
+     * @param prevRegistry Candidate patterns of the previous level
      * @param instances Current level star instances
      * @param prevInstances Previous level clique instances
-     * @return std::vector<ColocationInstance> Filtered clique instances
+     * @param arena Scratch arena of the current level, used for the match flags
+     * @return InstanceTable Filtered clique instances
+     */
+    InstanceTable filterCliqueInstances(
+        const PatternRegistry& registry,
+        const PatternRegistry& prevRegistry,
+        const InstanceTable& instances,
+        const InstanceTable& prevInstances,
+        LevelArena& arena
+    );
+
+    /**
+     * @brief Filter clique instances using the neighbor graph
+     *
+     * Used where the previous level holds no instance of a candidate's suffix:
+     * at k=3 (size-2 instances are never materialized) and in constrained mining
+     * (the suffix may lack a required feature). Instead of looking up the
+     * instance without its center, this checks that every two non-center
+     * instances are neighbors.
+     *
+     * @param instances Star instances
+     * @param neighborhoods Star neighborhoods used for the adjacency check
+     * @param arena Scratch arena of the current level, used for thread buffers
+     * @return InstanceTable Filtered clique instances
      */
-    std::vector<ColocationInstance> filterCliqueInstances(
-        const std::vector<Colocation>& candidates,
-        const std::vector<ColocationInstance>& instances,
-        const std::vector<ColocationInstance>& prevInstances
+    InstanceTable filterCliqueInstancesByAdjacency(
+        const InstanceTable& instances,
+        const NeighborhoodMgr& neighborhoods,
+        LevelArena& arena
+    );
+
+    /**
+     * @brief Select prevalent size-2 colocations directly from the star neighbor lists
+     *
+     * Every star of a center of feature a holds the instances of pattern {a, b} as
+     * its center and its group of b neighbors, so participation bitmaps of all
+     * candidate pairs are filled in one parallel pass over the stars (one task per
+     * center feature) without enumerating any instance. Stars of centers without a
+     * candidate, and groups of features no candidate pairs with them, are skipped.
+     *
+     * @param starNeighborhoods Star neighborhoods grouped by center feature type
+     * @param candidates Candidate size-2 patterns
+     * @param minPrev Minimum prevalence threshold
+     * @return std::vector<Pattern> Prevalent size-2 colocations, in sorted order
+     */
+    std::vector<Pattern> selectPrevPairs(
+        const std::unordered_map<FeatureType, std::vector<StarNeighborhood>>& starNeighborhoods,
+        const std::vector<Pattern>& candidates,
+        double minPrev
+    );
+
+    /**
+     * @brief Select coarse prevalent colocations directly from the star neighborhoods
+     *
+     * Computes the participation ratio each candidate would have over its star
+     * instances without enumerating them: a center participates when its star
+     * contains every other feature of the candidate, and then every neighbor of
+     * those features participates too.
+     *
+     * Candidates are scanned in parallel, one task each. Each candidate's scan
+     * ends early once it is known to be prevalent (every feature has enough
+     * participants) or infeasible (too few unscanned stars remain for the center
+     * feature to reach its threshold).
+     *
+     * @param candidates Vector of candidate patterns
+     * @param starNeighborhoods Star neighborhoods grouped by center feature type
+     * @param minPrev Minimum prevalence threshold
+     * @return std::vector<Pattern> Coarse prevalent candidates, in input order
+     */
+    std::vector<Pattern> selectCoarsePrevColocations(
+        const std::vector<Pattern>& candidates,
+        const std::unordered_map<FeatureType, std::vector<StarNeighborhood>>& starNeighborhoods,
+        double minPrev
     );
 
     /**
      * @brief Select prevalent colocations based on participation ratio
      * 
      * Calculates the participation ratio for each candidate and selects
-     * those that meet the minimum prevalence threshold.
+     * those that meet the minimum prevalence threshold. Participating instances
+     * are tracked in bitmaps per pattern slot, and a pattern stops being counted
+     * once all its features have enough participants.
+     *
+     * Rows are split across threads into thread-local bitmaps, allocated only for
+     * the patterns a thread meets; each pattern's bitmaps are then merged and its
+     * thresholds checked in parallel over patterns.
      * 
-     * @param candidates Vector of candidate patterns
-     * @param instances Colocation instances to evaluate
+     * @param registry Candidate patterns of the current level
+     * @param instances Colocation instances to evaluate, tagged with pattern IDs
      * @param minPrev Minimum prevalence threshold
-     * @param featureCount Map of feature type to total instance count
-     * @return std::vector<Colocation> Prevalent colocation patterns
+     * @return std::vector<Pattern> Prevalent colocation patterns, in ID order
      */
-    std::vector<Colocation> selectPrevColocations(
-        const std::vector<Colocation>& candidates,
-        const std::vector<ColocationInstance>& instances,
+    std::vector<Pattern> selectPrevColocations(
+        const PatternRegistry& registry,
+        const InstanceTable& instances,
+        double minPrev
+    );
+
+    /**
+     * @brief Mine every pattern extending a prefix, depth first
+     *
+     * Decides each one-feature extension of the prefix, then recurses into the
+     * prevalent ones (Eclat-style: a child is only extended by its later
+     * prevalent siblings), materializing one child's instances at a time.
+     *
+     * @param prefix Feature codes of the prefix pattern (prevalent)
+     * @param prefixInstances Clique instances of the prefix
+     * @param extensions Candidate features to append, ascending and greater than the prefix
+     * @param neighborhoods Star neighborhoods used to grow instances
+     * @param minPrev Minimum prevalence threshold
+     * @param pairPrevalent Flags of the prevalent size-2 patterns, indexed a * numFeatures + b
+     * @param found Output: prevalent patterns found below the prefix
+     */
+    void mineSubtree(
+        const Pattern& prefix,
+        const InstanceTable& prefixInstances,
+        const std::vector<FeatureCode>& extensions,
+        const NeighborhoodMgr& neighborhoods,
         double minPrev,
-        const std::map<FeatureType, int>& featureCount
+        const std::vector<char>& pairPrevalent,
+        std::vector<Pattern>& found
     );
 
+    /**
+     * @brief Grow the clique instances of a prefix by one feature and test prevalence
+     *
+     * Each prefix row is extended by the neighbors of the new feature in its first
+     * member's star that are neighbors of every other member too. Without an output
+     * table the scan stops as soon as the pattern is known to be prevalent or
+     * infeasible.
+     *
+     * @param prefixInstances Clique instances of the prefix (width k-1)
+     * @param pattern Feature codes of the extended pattern, new feature last
+     * @param neighborhoods Star neighborhoods used for candidate and adjacency lookups
+     * @param minPrev Minimum prevalence threshold
+     * @param extended Output table for the extended instances, or nullptr to only test
+     * @return bool True if the extended pattern is prevalent
+     */
+    bool extendCliqueInstances(
+        const InstanceTable& prefixInstances,
+        const Pattern& pattern,
+        const NeighborhoodMgr& neighborhoods,
+        double minPrev,
+        InstanceTable* extended
+    );
+
+    /**
+     * @brief Mine one level (k >= 3) with its instances kept under the memory budget
+     *
+     * Out-of-core counterpart of steps 3-5 of mineColocations(): star instances
+     * are streamed from the stars into a spilling ExternalSorter as query tuples
+     * (suffix ID, non-center members, pattern ID, center), and checked against
+     * the previous level's clique tuples by one external merge of the two sorted
+     * streams. At k=3 the missing edge is checked in the neighbor graph instead.
+     * Participation bitmaps are filled as cliques are found.
+     *
+     * @param registry Candidate patterns of the current level
+     * @param prevRegistry Candidate patterns of the previous level
+     * @param neighborhoods Star neighborhoods to enumerate
+     * @param prevCliques Previous level clique tuples (pattern ID, members), nullptr at k=3
+     * @param cliques Output: this level's clique tuples (finished on return)
+     * @param minPrev Minimum prevalence threshold
+     * @return std::vector<Pattern> Prevalent colocation patterns, in ID order
+     */
+    std::vector<Pattern> selectPrevColocationsOutOfCore(
+        const PatternRegistry& registry,
+        const PatternRegistry& prevRegistry,
+        const NeighborhoodMgr& neighborhoods,
+        const ExternalSorter* prevCliques,
+        ExternalSorter& cliques,
+        double minPrev
+    );
+
+    /**
+     * @brief Save the state after a completed level to the checkpoint store
+     *
+     * @param k Pattern size of the completed level
+     * @param allPrevalent Prevalent patterns found so far
+     * @param registry Candidates of the level
+     * @param cliques Clique instances of the level (in memory)
+     * @param cliqueRuns Clique tuples of the level under a memory budget, or nullptr
+     */
+    void saveLevelCheckpoint(
+        int k,
+        const std::vector<Pattern>& allPrevalent,
+        const PatternRegistry& registry,
+        const InstanceTable& cliques,
+        const ExternalSorter* cliqueRuns
+    ) const;
+
+    /**
+     * @brief Rebuild a level's clique instances from checkpointed tuples
+     *
+     * @param state Level read back from a checkpoint
+     * @param registry Candidates of the level, in checkpoint order
+     * @param instances Vector of all spatial instances
+     * @param cliques Output: clique instances, filled without a memory budget
+     * @param cliqueRuns Output: clique tuples, filled under a memory budget
+     */
+    void restoreCliques(
+        const LevelState& state,
+        const PatternRegistry& registry,
+        const std::vector<SpatialInstance>& instances,
+        InstanceTable& cliques,
+        std::unique_ptr<ExternalSorter>& cliqueRuns
+    ) const;
+
 public:
+    /**
+     * @brief Restrict mining to patterns containing and excluding given features
+     *
+     * The constraints are pushed into the search: excluded features never enter a
+     * candidate, and with included features only the sublattice of patterns
+     * holding all of them is generated (see generateConstrainedCandidates()), so
+     * stars of other centers and groups of other features are never enumerated.
+     * Clique instances are then checked in the neighbor graph, since a
+     * candidate's suffix may lie outside the sublattice. mineColocationsDepthFirst()
+     * skips prefix classes and subtrees that cannot reach every included feature
+     * (see requiredReachable()).
+     *
+     * More than kMaxPatternSize included features match no pattern; a warning is
+     * printed when mining resolves such a set.
+     *
+     * @param include Features every pattern must contain (empty = no constraint)
+     * @param exclude Features no pattern may contain
+     */
+    void setFeatureConstraints(const std::vector<FeatureType>& include, const std::vector<FeatureType>& exclude);
+
+    /**
+     * @brief Explain why no pattern of a dataset can satisfy the feature constraints
+     *
+     * @param instances Instances that would be mined
+     * @return std::string The conflict (an included feature that is absent from the
+     *         instances or also excluded), or empty if the constraints can be met
+     */
+    std::string constraintConflict(const std::vector<SpatialInstance>& instances) const;
+
+    /**
+     * @brief Save a checkpoint after every level of mineColocations(), and optionally resume
+     *
+     * After each completed level the prevalent patterns so far, the level's
+     * candidates and its clique instances are written to the store, replacing the
+     * previous level. When resuming, mining continues after the level stored under
+     * the same fingerprint, if any; otherwise it starts from size-2 patterns.
+     *
+     * @param store Checkpoint store (nullptr disables checkpoints); must outlive mining
+     * @param key Fingerprint of the dataset and mining parameters
+     * @param resume Continue from the stored level instead of starting afresh
+     */
+    void enableCheckpoints(const CheckpointStore* store, uint64_t key, bool resume);
+
+    /** @brief Level the last mineColocations() resumed after (0 if it started afresh) */
+    uint32_t resumedLevel() const { return resumedFrom; }
+
+    /**
+     * @brief Bound the memory used by level instance tables, spilling to disk beyond it
+     *
+     * With a budget, levels from k=3 on keep their star and clique instances in
+     * sorted, compressed runs on disk once they outgrow it (see
+     * selectPrevColocationsOutOfCore()), so large distances finish slower instead
+     * of running out of memory.
+     *
+     * @param bytes Memory budget in bytes (0 = unlimited, fully in memory)
+     * @param spillDir Directory for spilled runs (empty = system temporary directory)
+     */
+    void setMemoryBudget(size_t bytes, const std::string& spillDir = "");
+
+    /**
+     * @brief Count only the leading instances of each feature in prevalence
+     *
+     * For region mining (see RegionView): instances of feature code f with a
+     * featureIndex below sizes[f] lie in the region, and the others form its
+     * halo. Halo instances may complete clique instances, but only in-region
+     * instances count as participants and in the participation ratios'
+     * denominators.
+     *
+     * @param sizes In-region instances per feature code (empty = count all instances)
+     */
+    void setCoreSizes(const std::vector<size_t>& sizes);
+
+    /**
+     * @brief Generate (k+1)-size candidates from k-size prevalent patterns of feature codes
+     *
+     * Apriori-gen over Pattern values: patterns sharing their first k-1 features are
+     * joined, and candidates with a non-prevalent k-subset are pruned. No candidate
+     * larger than kMaxPatternSize is generated; a warning is printed (once) when
+     * the cap drops joins that would otherwise be made.
+     *
+     * @param prevPrevalent k-size prevalent patterns
+     * @return std::vector<Pattern> (k+1)-size candidates, in sorted order
+     */
+    static std::vector<Pattern> generateCandidatePatterns(const std::vector<Pattern>& prevPrevalent);
+
+    /**
+     * @brief Smallest participant count giving a feature a ratio of at least minPrev
+     *
+     * Lets the mining loop compare counts instead of ratios, and decide a
+     * candidate's prevalence while its participants are still being counted.
+     *
+     * @param minPrev Minimum prevalence threshold
+     * @param featureSize Number of instances of the feature
+     * @return size_t Participant threshold (featureSize + 1 if it cannot be reached)
+     */
+    static size_t participationThreshold(double minPrev, size_t featureSize);
+
     /**
      * @brief Mine prevalent colocation patterns using the joinless algorithm
      * 
@@ -104,6 +510,45 @@ public:
         const std::vector<SpatialInstance>& instances
     );
     
+    /**
+     * @brief Mine prevalent colocation patterns depth first, one prefix class at a time
+     *
+     * Alternative to mineColocations() that bounds memory by the size of one
+     * subtree: after the size-2 patterns, every prevalent pair {a, b} is a prefix
+     * class whose patterns are mined to completion as an independent parallel
+     * task, with instance tables scoped to the path being explored. Results are
+     * the same patterns, in the same order, as mineColocations().
+     *
+     * @param minPrevalence Minimum prevalence threshold (0.0 to 1.0)
+     * @param nbrMgr Pointer to neighborhood manager containing star neighborhoods
+     * @param instances Vector of all spatial instances
+     * @return std::vector<Colocation> All discovered prevalent colocation patterns
+     */
+    std::vector<Colocation> mineColocationsDepthFirst(
+        double minPrevalence,
+        NeighborhoodMgr* nbrMgr,
+        const std::vector<SpatialInstance>& instances
+    );
+
+    /**
+     * @brief Compute the exact participation index of given patterns
+     *
+     * Mining only counts participants until a pattern is known to be prevalent,
+     * so this enumerates every clique instance of each pattern instead, growing
+     * it feature by feature from its size-2 instances. Patterns are evaluated in
+     * parallel, one task each.
+     *
+     * @param patterns Colocation patterns (at least two features each)
+     * @param nbrMgr Pointer to neighborhood manager containing star neighborhoods
+     * @param instances Vector of all spatial instances
+     * @return std::vector<double> Participation index of each pattern, in input order
+     */
+    std::vector<double> participationIndices(
+        const std::vector<Colocation>& patterns,
+        NeighborhoodMgr* nbrMgr,
+        const std::vector<SpatialInstance>& instances
+    );
+
     /**
      * @brief Generate (k+1)-size candidate patterns from k-size prevalent patterns
      * 
@@ -0,0 +1,133 @@
+/**
+ * @file mining_server.h
+ * @brief Long-lived mining service answering JSON requests over a Unix-domain socket
+ */
+
+#pragma once
+#include "types.h"
+#include "config.h"
+#include "neighborhood_mgr.h"
+#include "spatial_index.h"
+#include "spatial_order.h"
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * @brief MiningServer class keeping datasets and their star neighborhoods resident
+ *
+ * The server listens on a Unix-domain socket. Each connection sends requests as
+ * one JSON object per line and gets one JSON object per line back:
+ *
+ *     {"dataset": "data.csv", "distance": 120, "min_prevalence": 0.2,
+ *      "features": ["A", "B"], "exclude": ["C"], "region": "0,0,500,400", "top_k": 10}
+ *
+ * Every field is optional and defaults to the server configuration. `features`
+ * keeps the patterns containing all listed features and `exclude` those containing
+ * none of its features (both default to the configured constraints and are pushed
+ * into the search, see JoinlessMiner::setFeatureConstraints()); `region` mines only
+ * the instances of a rectangle or WKT polygon (see RegionView); `top_k` keeps the k patterns
+ * with the highest participation index and reports it. The reply is
+ *
+ *     {"status": "ok", "patterns": [{"features": ["A", "B"], ...}, ...],
+ *      "graph_cached": true, "elapsed_ms": 12.5}
+ *
+ * or {"status": "error", "message": "..."}.
+ *
+ * A dataset is parsed once, on its first request, and its spatial index and star
+ * neighborhoods are built once per distance and shared read-only by every later
+ * query; region queries are cut from them without any new neighbor search. One
+ * thread polls every connection and hands each complete request to a thread pool,
+ * so idle connections hold no worker; a connection's requests are answered in
+ * order, and each query's mining runs on its share of the OpenMP threads. A
+ * request line longer than kMaxRequestBytes gets an error and closes the
+ * connection. Concurrent requests for a dataset or distance not loaded yet wait
+ * for a single load instead of repeating it.
+ */
+class MiningServer {
+private:
+    /**
+     * @brief Spatial index and star neighborhoods of a dataset at one distance
+     */
+    struct Graph {
+        SpatialIndex index;      ///< Grid the stars were found with, kept for region queries
+        NeighborhoodMgr stars;   ///< Star neighborhoods of every instance
+
+        explicit Graph(double distance) : index(distance) {}
+    };
+
+    /**
+     * @brief One resident dataset and the neighborhoods built over it
+     */
+    struct Dataset {
+        std::vector<SpatialInstance> instances;   ///< Instances, with feature codes assigned
+        std::mutex mutex;                         ///< Guards `graphs`
+        std::map<double, std::shared_future<std::shared_ptr<Graph>>> graphs;  ///< Distance -> index and stars
+    };
+
+    static constexpr size_t kMaxRequestBytes = 1 << 20;  ///< Longest request line accepted
+    static constexpr int kAcceptBackoffMs = 100;         ///< Pause in accepting when out of descriptors
+
+    AppConfig config;            ///< Defaults of every request and mining settings
+    SpatialOrder order;          ///< Load-time ordering of datasets
+    std::mutex datasetsMutex;    ///< Guards `datasets`
+    std::map<std::string, std::shared_future<std::shared_ptr<Dataset>>> datasets;  ///< Path -> dataset
+
+    /**
+     * @brief Get a dataset, loading it on first use
+     *
+     * @param path CSV file of the dataset
+     * @return std::shared_ptr<Dataset> Resident dataset
+     */
+    std::shared_ptr<Dataset> dataset(const std::string& path);
+
+    /**
+     * @brief Get the index and star neighborhoods of a dataset at a distance, building them on first use
+     *
+     * @param data Resident dataset
+     * @param distance Neighbor distance threshold
+     * @param cached Output: true if they had been built by an earlier request
+     * @return std::shared_ptr<Graph> Index and star neighborhoods (shared, read-only)
+     */
+    std::shared_ptr<Graph> neighborhoods(Dataset& data, double distance, bool& cached);
+
+    /**
+     * @brief Answer one request line
+     *
+     * @param line JSON request
+     * @return std::string JSON reply, without the trailing newline
+     */
+    std::string handleRequest(const std::string& line);
+
+    /**
+     * @brief Write a whole reply to a connected socket
+     *
+     * @param fd Connected socket
+     * @param data Bytes to send
+     * @return bool False if the connection failed before everything was sent
+     */
+    static bool sendAll(int fd, const std::string& data);
+
+public:
+    /**
+     * @brief Constructor taking the server and default mining settings
+     *
+     * @param settings Application configuration (server_socket, server_threads,
+     *        default dataset, distance and prevalence)
+     */
+    explicit MiningServer(const AppConfig& settings);
+
+    MiningServer(const MiningServer&) = delete;
+    MiningServer& operator=(const MiningServer&) = delete;
+
+    /**
+     * @brief Preload the default dataset and distance, then serve requests forever
+     *
+     * @throws std::runtime_error If the socket cannot be created, or on platforms
+     *         without Unix-domain sockets
+     */
+    void run();
+};
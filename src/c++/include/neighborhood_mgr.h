@@ -5,6 +5,7 @@
 
 #pragma once
 #include "types.h"
+#include "spatial_index.h"
 #include <unordered_map>
 #include <vector>
 
@@ -13,23 +14,78 @@
  * 
  * Organizes spatial instances into star neighborhoods, where each star consists of
  * a center instance and all its neighbors within the distance threshold.
+ *
+ * Neighbor lists and feature groups of all stars are stored back to back in two
+ * shared arrays; each StarNeighborhood only holds views into them.
  */
 class NeighborhoodMgr {
 private:
     /// Map from feature type to all star neighborhoods of that type
     std::unordered_map<FeatureType, std::vector<StarNeighborhood>> starNeighborhoods;
 
+    std::vector<const SpatialInstance*> neighborPool;  ///< Neighbors of every star, star after star
+    std::vector<NeighborGroup> groupPool;              ///< Feature groups of every star, star after star
+    std::vector<size_t> starLookupOffsets;             ///< Per center feature code: first slot in starLookup
+    std::vector<const StarNeighborhood*> starLookup;   ///< Star of each (feature, featureIndex), nullptr if none
+
+    /**
+     * @brief Build the feature groups and star views once neighborPool is filled
+     *
+     * Each center's run of neighborPool must already be sorted by feature code.
+     *
+     * @param centers Center instance of each run
+     * @param offsets Run boundaries in neighborPool (size centers.size() + 1)
+     */
+    void finalizeStars(const std::vector<const SpatialInstance*>& centers, const std::vector<size_t>& offsets);
+
 public:
+    NeighborhoodMgr() = default;
+    NeighborhoodMgr(const NeighborhoodMgr&) = delete;
+    NeighborhoodMgr& operator=(const NeighborhoodMgr&) = delete;
+    NeighborhoodMgr(NeighborhoodMgr&&) = default;
+    NeighborhoodMgr& operator=(NeighborhoodMgr&&) = default;
+
     /**
      * @brief Build star neighborhoods from neighbor pairs
      * 
      * Constructs star neighborhoods by grouping neighbor pairs. For each instance,
-     * creates a star with that instance as center and all its neighbors.
+     * creates a star with that instance as center and all its neighbors, sorted
+     * and grouped by neighbor feature. Instances are identified by ID, and every
+     * star refers to one canonical copy of each instance.
      * 
-     * @param pairs Vector of neighbor pairs found by spatial indexing
+     * @param pairs Vector of neighbor pairs found by spatial indexing; stars point
+     *        into it, so it must outlive the manager
      */
     void buildFromPairs(const std::vector<std::pair<SpatialInstance, SpatialInstance>>& pairs);
 
+    /**
+     * @brief Build star neighborhoods directly from a neighbor search
+     *
+     * Fuses neighbor search and star construction: every center's star neighbors
+     * (neighbors with a greater feature code) are emitted by the spatial index
+     * already ordered by feature and instance, in parallel, without materializing
+     * neighbor pairs.
+     *
+     * @param instances Vector of all spatial instances; stars point into it
+     * @param index Spatial index configured with the distance threshold
+     */
+    void buildFromIndex(const std::vector<SpatialInstance>& instances, SpatialIndex& index);
+
+    /**
+     * @brief Build star neighborhoods from precomputed star neighbor lists
+     *
+     * Star construction half of buildFromIndex(), for neighbor lists produced by
+     * SpatialIndex::findStarNeighbors() earlier (e.g. read back from a checkpoint).
+     *
+     * @param instances Vector of all spatial instances; stars point into it
+     * @param offsets List boundaries in `neighbors` (size instances.size() + 1)
+     * @param neighbors Star neighbor positions of every instance, each list ordered
+     *        by feature and instance; released once converted
+     */
+    void buildFromStarLists(const std::vector<SpatialInstance>& instances,
+                            const std::vector<size_t>& offsets,
+                            std::vector<uint32_t> neighbors);
+
     
     /**
      * @brief Get all star neighborhoods organized by feature type
@@ -38,4 +94,21 @@ public:
      *         Map from feature type to vector of star neighborhoods
      */
     const std::unordered_map<FeatureType, std::vector<StarNeighborhood>>& getAllStarNeighborhoods() const;
-};
\ No newline at end of file
+
+    /**
+     * @brief Find the star centered on an instance
+     *
+     * @param center Center instance
+     * @return const StarNeighborhood* Its star, or nullptr if it has no star neighbor
+     */
+    const StarNeighborhood* findStar(const SpatialInstance* center) const;
+
+    /**
+     * @brief Check whether two instances are neighbors, using the star of the first
+     *
+     * @param a Instance with the smaller feature code
+     * @param b Instance with the greater feature code
+     * @return bool True if b is a star neighbor of a
+     */
+    bool areNeighbors(const SpatialInstance* a, const SpatialInstance* b) const;
+};
@@ -0,0 +1,119 @@
+/**
+ * @file partitioned_miner.h
+ * @brief Colocation mining over spatial tiles served by worker processes
+ */
+
+#pragma once
+#include "types.h"
+#include "pattern.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @brief PartitionedMiner class splitting neighbor search and star construction across tiles
+ *
+ * The bounding box of the dataset is cut into a grid of tiles. Each tile holds
+ * the instances of its core rectangle plus a halo of every instance within one
+ * neighbor distance of the core, so the tile can build the complete star of each
+ * core instance on its own (see TileWorker).
+ *
+ * Tiles are assigned to worker processes, longest estimated cost first to the
+ * least loaded worker. Workers are fresh processes of the worker executable
+ * started in worker mode (see runWorker()) and receive their tiles over pipes;
+ * on Windows, with a single worker, or without a worker executable, tiles are
+ * served in process. A tile's cost is estimated from a grid of cells of one
+ * neighbor distance: each core instance weighs the number of instances in the 3x3
+ * cells around it, an upper bound on its star size.
+ *
+ * Mining then proceeds level by level as in JoinlessMiner: the coordinator sends
+ * the candidates of a level to every worker, ORs the participants they report into
+ * global participation bitmaps, and decides prevalence exactly from those before
+ * generating the next level. The neighbor graph only ever exists tile by tile, in
+ * the workers.
+ */
+class PartitionedMiner {
+private:
+    /**
+     * @brief One tile of the partition
+     */
+    struct Tile {
+        std::vector<uint32_t> members;  ///< Positions of core and halo instances, ascending
+        std::vector<char> owned;        ///< Per member: true if it lies in the core
+        double cost = 0.0;              ///< Estimated mining cost
+    };
+
+    double distanceThreshold;  ///< Distance threshold for neighbor determination
+    size_t tilesPerSide;       ///< The grid has tilesPerSide x tilesPerSide tiles
+    size_t numWorkers;         ///< Number of worker processes
+    std::string workerExecutable;  ///< Program started for each worker, empty to serve tiles in process
+
+    /**
+     * @brief Cut the bounding box into tiles and collect each tile's core and halo
+     *
+     * @param instances Vector of all spatial instances
+     * @return std::vector<Tile> Tiles holding at least one core instance
+     */
+    std::vector<Tile> partition(const std::vector<SpatialInstance>& instances) const;
+
+    /**
+     * @brief Estimate each tile's cost from the instance density around its core
+     *
+     * @param instances Vector of all spatial instances
+     * @param tiles Tiles whose cost is filled in
+     */
+    void estimateCosts(const std::vector<SpatialInstance>& instances, std::vector<Tile>& tiles) const;
+
+    /**
+     * @brief Assign tiles to workers, most expensive first to the least loaded worker
+     *
+     * @param tiles Tiles with estimated costs
+     * @param workers Number of workers
+     * @return std::vector<std::vector<size_t>> Tile indices of each worker
+     */
+    static std::vector<std::vector<size_t>> scheduleTiles(const std::vector<Tile>& tiles, size_t workers);
+
+public:
+    /// Command-line flag selecting worker mode, followed by the request and reply descriptors
+    static constexpr const char* kWorkerFlag = "--partition-worker";
+
+    /**
+     * @brief Constructor to initialize the partitioning parameters
+     *
+     * @param distThresh Maximum distance for two instances to be considered neighbors
+     * @param tilesPerSide Number of tiles along each axis
+     * @param workers Number of worker processes
+     */
+    PartitionedMiner(double distThresh, size_t tilesPerSide, size_t workers);
+
+    /**
+     * @brief Set the program started for each worker
+     *
+     * The program must call runWorker() when given kWorkerFlag, before any
+     * other work.
+     *
+     * @param path Path of the worker executable
+     */
+    void setWorkerExecutable(const std::string& path);
+
+    /**
+     * @brief Serve tiles as a worker process until the coordinator stops it
+     *
+     * @param requests Descriptor the tiles and candidates are read from
+     * @param replies Descriptor the participants are written to
+     * @return int Process exit status
+     */
+    static int runWorker(int requests, int replies);
+
+    /**
+     * @brief Mine prevalent colocation patterns tile by tile
+     *
+     * Results are the same patterns, in the same order, as
+     * JoinlessMiner::mineColocations().
+     *
+     * @param minPrev Minimum prevalence threshold (0.0 to 1.0)
+     * @param instances Vector of all spatial instances, with feature codes assigned
+     * @return std::vector<Colocation> All discovered prevalent colocation patterns
+     */
+    std::vector<Colocation> mineColocations(double minPrev, const std::vector<SpatialInstance>& instances);
+};
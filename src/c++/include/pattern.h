@@ -0,0 +1,121 @@
+/**
+ * @file pattern.h
+ * @brief Inline fixed-capacity colocation pattern over feature codes
+ */
+
+#pragma once
+#include "types.h"
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <type_traits>
+
+/** @brief Largest pattern size the miner handles (patterns are stored inline) */
+constexpr size_t kMaxPatternSize = 16;
+
+/**
+ * @brief Colocation pattern as an inline array of feature codes
+ *
+ * The internal counterpart of Colocation: codes are kept in ascending order (which
+ * is the order of the feature names), stored inline so building, copying and
+ * taking subsets of patterns never touches the heap, and the hash is maintained as
+ * codes are appended so hash lookups cost no pass over the pattern.
+ */
+class Pattern {
+private:
+    FeatureCode codes[kMaxPatternSize];   ///< Feature codes, first `count` are valid
+    uint32_t count = 0;                   ///< Number of features
+    uint64_t hashValue = kHashSeed;       ///< Hash of codes[0, count)
+
+    static constexpr uint64_t kHashSeed = 0xcbf29ce484222325ull;
+
+    static uint64_t combine(uint64_t h, FeatureCode code) {
+        return (h ^ code) * 0x100000001b3ull;
+    }
+
+public:
+    Pattern() = default;
+
+    /** @brief Build a pattern from `n` feature codes */
+    Pattern(const FeatureCode* first, size_t n) {
+        for (size_t i = 0; i < n; ++i) push_back(first[i]);
+    }
+
+    /** @brief Append a feature code */
+    void push_back(FeatureCode code) {
+        if (count == kMaxPatternSize) {
+            throw std::length_error("Pattern exceeds kMaxPatternSize features");
+        }
+        codes[count++] = code;
+        hashValue = combine(hashValue, code);
+    }
+
+    /** @brief Remove the last feature code */
+    void pop_back() {
+        if (count == 0) {
+            throw std::out_of_range("pop_back on an empty Pattern");
+        }
+        --count;
+        hashValue = kHashSeed;
+        for (uint32_t i = 0; i < count; ++i) hashValue = combine(hashValue, codes[i]);
+    }
+
+    /** @brief The pattern with the feature at `slot` removed */
+    Pattern without(size_t slot) const {
+        Pattern subset;
+        for (uint32_t i = 0; i < count; ++i) {
+            if (i != slot) subset.push_back(codes[i]);
+        }
+        return subset;
+    }
+
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    const FeatureCode* data() const { return codes; }
+    const FeatureCode* begin() const { return codes; }
+    const FeatureCode* end() const { return codes + count; }
+    FeatureCode operator[](size_t i) const { return codes[i]; }
+    FeatureCode back() const { return codes[count - 1]; }
+    uint64_t hash() const { return hashValue; }
+
+    friend bool operator==(const Pattern& a, const Pattern& b) {
+        return a.hashValue == b.hashValue && a.count == b.count &&
+               std::memcmp(a.codes, b.codes, a.count * sizeof(FeatureCode)) == 0;
+    }
+
+    friend bool operator!=(const Pattern& a, const Pattern& b) { return !(a == b); }
+
+    friend bool operator<(const Pattern& a, const Pattern& b) {
+        for (uint32_t i = 0; i < a.count && i < b.count; ++i) {
+            if (a.codes[i] != b.codes[i]) return a.codes[i] < b.codes[i];
+        }
+        return a.count < b.count;
+    }
+};
+
+/** @brief Hash functor for unordered containers keyed by Pattern */
+struct PatternHash {
+    size_t operator()(const Pattern& pattern) const { return static_cast<size_t>(pattern.hash()); }
+};
+
+/**
+ * @brief Invoke a kernel specialized for the pattern size
+ *
+ * Calls f(std::integral_constant<size_t, K>()) with K = k for the common sizes
+ * 2 to 5, so loops over the pattern unroll, and with K = 0 for any other size,
+ * in which case the kernel falls back to the runtime size.
+ *
+ * @param k Pattern size
+ * @param f Kernel taking the size constant
+ */
+template <typename F>
+decltype(auto) dispatchPatternSize(size_t k, F&& f) {
+    switch (k) {
+        case 2: return f(std::integral_constant<size_t, 2>());
+        case 3: return f(std::integral_constant<size_t, 3>());
+        case 4: return f(std::integral_constant<size_t, 4>());
+        case 5: return f(std::integral_constant<size_t, 5>());
+        default: return f(std::integral_constant<size_t, 0>());
+    }
+}
@@ -0,0 +1,61 @@
+/**
+ * @file pattern_registry.h
+ * @brief Dense integer identifiers for the candidate patterns of one level
+ */
+
+#pragma once
+#include "types.h"
+#include "pattern.h"
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief PatternRegistry class assigning dense IDs to the candidates of a level
+ *
+ * Every candidate of size k gets the ID of its position in the registry, so per-candidate
+ * state (participation bitmaps, counters) lives in flat arrays indexed by pattern ID and
+ * each row of an InstanceTable only needs to record the ID of its pattern.
+ */
+class PatternRegistry {
+private:
+    size_t width = 0;                                          ///< Pattern size k
+    std::vector<Pattern> entries;                              ///< Pattern of each ID
+    std::unordered_map<Pattern, PatternId, PatternHash> ids;   ///< Pattern -> pattern ID
+
+public:
+    /** @brief Marker returned by find() for unregistered patterns */
+    static constexpr PatternId kNone = static_cast<PatternId>(-1);
+
+    /**
+     * @brief Register a pattern and return its ID
+     *
+     * Registering a pattern twice returns the ID it already has.
+     *
+     * @param pattern Pattern to register
+     * @return PatternId Dense ID of the pattern
+     */
+    PatternId add(const Pattern& pattern);
+
+    /**
+     * @brief Look up the ID of a pattern
+     *
+     * @param pattern Pattern to look up
+     * @return PatternId ID of the pattern, or kNone if it is not registered
+     */
+    PatternId find(const Pattern& pattern) const;
+
+    /** @brief Number of registered patterns */
+    size_t size() const { return entries.size(); }
+
+    /** @brief Pattern size k (0 while the registry is empty) */
+    size_t patternSize() const { return width; }
+
+    /** @brief Pattern with a given ID */
+    const Pattern& pattern(PatternId id) const { return entries[id]; }
+
+    /** @brief Feature codes of the pattern with a given ID */
+    const FeatureCode* patternCodes(PatternId id) const { return entries[id].data(); }
+
+    /** @brief All registered patterns, in ID order */
+    const std::vector<Pattern>& patterns() const { return entries; }
+};
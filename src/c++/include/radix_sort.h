@@ -0,0 +1,41 @@
+/**
+ * @file radix_sort.h
+ * @brief Parallel LSD radix sorts over 32-bit keys and packed integer tuples
+ */
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief Stable parallel LSD radix sort of (key, value) pairs by key
+ *
+ * Sorts 8 bits per pass with per-thread histograms; passes whose digit is the
+ * same for every key are skipped, so small keys cost fewer passes.
+ *
+ * @param keys Keys to sort (sorted in place)
+ * @param values Values carried along with the keys (same size as keys)
+ */
+void radixSortPairs(std::vector<uint32_t>& keys, std::vector<uint32_t>& values);
+
+/**
+ * @brief Stable parallel LSD radix sort of (key, value) pairs by 64-bit key
+ *
+ * @param keys Keys to sort (sorted in place)
+ * @param values Values carried along with the keys (same size as keys)
+ */
+void radixSortPairs(std::vector<uint64_t>& keys, std::vector<uint32_t>& values);
+
+/**
+ * @brief Stable lexicographic sort of packed integer tuples
+ *
+ * Tuples are stored back to back, `width` words each. The tuples are radix
+ * sorted column by column, last column first, and then rewritten in sorted
+ * order so later scans stream through them.
+ *
+ * @param tuples Packed tuples (count * width words), rewritten in sorted order
+ * @param width Words per tuple
+ * @param order Output: original position of each tuple in sorted order
+ */
+void radixSortTuples(std::vector<uint32_t>& tuples, size_t width, std::vector<uint32_t>& order);
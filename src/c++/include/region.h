@@ -0,0 +1,53 @@
+/**
+ * @file region.h
+ * @brief Region of interest for mining part of a dataset: a rectangle or a polygon
+ */
+
+#pragma once
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Region class describing an axis-aligned rectangle or a WKT polygon
+ *
+ * A region is written either as four numbers "minX,minY,maxX,maxY" or as a WKT
+ * POLYGON, whose first ring is the outline and further rings are holes:
+ *
+ *     POLYGON((0 0, 100 0, 100 80, 0 80, 0 0), (40 30, 60 30, 60 50, 40 30))
+ *
+ * Points of a polygon are inside by the even-odd rule over all rings; points of a
+ * rectangle are inside including its border.
+ */
+class Region {
+private:
+    double left = 0.0;     ///< Bounding box of the region
+    double bottom = 0.0;
+    double right = 0.0;
+    double top = 0.0;
+    std::vector<std::vector<std::pair<double, double>>> rings;  ///< Polygon rings (empty for a rectangle)
+
+public:
+    /**
+     * @brief Parse a region from a rectangle or WKT polygon
+     *
+     * @param spec "minX,minY,maxX,maxY" or "POLYGON((x y, ...), ...)"
+     * @return Region Parsed region
+     * @throws std::invalid_argument If the text is neither form, or the region is empty
+     */
+    static Region parse(const std::string& spec);
+
+    /**
+     * @brief Check whether a point lies in the region
+     */
+    bool contains(double x, double y) const;
+
+    /** @brief Bounding box of the region */
+    double minX() const { return left; }
+    double minY() const { return bottom; }
+    double maxX() const { return right; }
+    double maxY() const { return top; }
+
+    /** @brief True if the region is a polygon rather than a rectangle */
+    bool isPolygon() const { return !rings.empty(); }
+};
@@ -0,0 +1,66 @@
+/**
+ * @file region_view.h
+ * @brief Instances and star neighborhoods of a region of interest, cut from a resident dataset
+ */
+
+#pragma once
+#include "types.h"
+#include "region.h"
+#include "spatial_index.h"
+#include "neighborhood_mgr.h"
+#include <vector>
+
+/**
+ * @brief RegionView class extracting a region of a dataset for mining, reusing its index
+ *
+ * The instances inside the region (its core) are found by a range query on the
+ * dataset's spatial index. Its halo is every instance outside the region within
+ * one neighbor distance of a core instance: clique instances with a core member
+ * lie in the core and the halo, so halo instances let boundary instances take
+ * part in cliques crossing the border. Core and halo come from the dataset's star
+ * neighborhoods, and the region's stars are those stars restricted to it, so no
+ * neighbor search is repeated.
+ *
+ * Region instances are copied core first, then halo, and recoded over the
+ * features of the core, so the first getCoreSizes()[f] instances of feature f
+ * (by featureIndex) are in the region; halo instances of features absent from the
+ * core are dropped. Mine with JoinlessMiner::setCoreSizes(getCoreSizes()) so
+ * prevalence counts and denominators cover in-region instances only.
+ */
+class RegionView {
+private:
+    std::vector<SpatialInstance> instances;  ///< Core instances, then halo instances
+    std::vector<size_t> coreSizes;           ///< Per feature code: number of core instances
+    size_t coreCount = 0;                    ///< Number of core instances
+    NeighborhoodMgr neighborhoods;           ///< Stars of the region instances
+
+public:
+    /**
+     * @brief Extract a region from a dataset
+     *
+     * Costs in proportion to the region and its halo, not to the dataset.
+     *
+     * @param region Region of interest
+     * @param dataset All instances, with feature codes assigned
+     * @param distance Neighbor distance the stars were built with
+     * @param index Spatial index built over `dataset`
+     * @param stars Star neighborhoods built over `dataset`
+     */
+    RegionView(const Region& region, const std::vector<SpatialInstance>& dataset, double distance,
+               const SpatialIndex& index, const NeighborhoodMgr& stars);
+
+    RegionView(const RegionView&) = delete;
+    RegionView& operator=(const RegionView&) = delete;
+
+    /** @brief Core and halo instances, with feature codes of the region */
+    const std::vector<SpatialInstance>& getInstances() const { return instances; }
+
+    /** @brief Star neighborhoods of the region instances */
+    NeighborhoodMgr& getNeighborhoods() { return neighborhoods; }
+
+    /** @brief Number of core instances of each feature code of the region */
+    const std::vector<size_t>& getCoreSizes() const { return coreSizes; }
+
+    /** @brief Number of instances inside the region */
+    size_t coreSize() const { return coreCount; }
+};
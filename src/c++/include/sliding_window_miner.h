@@ -0,0 +1,71 @@
+/**
+ * @file sliding_window_miner.h
+ * @brief Colocation mining over a sliding time window of spatial events
+ */
+
+#pragma once
+#include "types.h"
+#include "incremental_miner.h"
+#include <deque>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief SlidingWindowMiner class maintaining prevalent colocations over a time window
+ *
+ * The window holds the events with a timestamp in (now - windowLength, now]. Each
+ * call to advance() moves `now` forward, adds the events that arrived and expires
+ * the ones that fell out of the window, and hands both to an IncrementalMiner as a
+ * single batch, so the window is never mined from scratch.
+ *
+ * An event whose instance ID is already in the window replaces the earlier
+ * observation (the instance moved); the earlier event then expires silently.
+ */
+class SlidingWindowMiner {
+private:
+    IncrementalMiner engine;   ///< Mining state of the current window
+    double windowLength;       ///< Length of the window, in the events' time unit
+    double now;                ///< End of the current window
+
+    std::deque<SpatialEvent> window;                  ///< Events in the window, by timestamp
+    std::unordered_map<instanceID, double> latest;    ///< Instance ID -> timestamp of its live observation
+
+public:
+    /**
+     * @brief Constructor to initialize the miner with its mining and window parameters
+     *
+     * @param distThresh Maximum distance for two instances to be considered neighbors
+     * @param minPrevalence Minimum prevalence threshold (0.0 to 1.0)
+     * @param windowLen Length of the sliding window
+     */
+    SlidingWindowMiner(double distThresh, double minPrevalence, double windowLen);
+
+    /**
+     * @brief Add arrived events, slide the window end to a new time and update the result
+     *
+     * Arrivals older than the new window start are dropped. Late arrivals (older
+     * than events already in the window) are accepted.
+     *
+     * @param arrivals Events observed since the previous call
+     * @param until New end of the window (not before the current one)
+     * @return MiningDelta Patterns that gained or lost prevalence
+     */
+    MiningDelta advance(const std::vector<SpatialEvent>& arrivals, double until);
+
+    /**
+     * @brief Prevalent patterns of the current window
+     *
+     * @return std::vector<Colocation> Prevalent colocation patterns
+     */
+    std::vector<Colocation> prevalentPatterns() const { return engine.prevalentPatterns(); }
+
+    /**
+     * @brief Number of live instances in the window
+     */
+    size_t size() const { return engine.size(); }
+
+    /**
+     * @brief End of the current window
+     */
+    double windowEnd() const { return now; }
+};
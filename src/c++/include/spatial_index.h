@@ -5,44 +5,178 @@
 
 #pragma once
 #include "types.h"
+#include <cstdint>
+#include <unordered_map>
 #include <vector>
 
 /**
  * @brief SpatialIndex class for managing spatial indexing and neighbor searches
- * 
+ *
  * Provides functionality to find neighboring spatial instances within a distance threshold.
- * Currently uses a brute-force O(n²) approach for neighbor pair detection.
+ * Instances are bucketed into a grid of cells whose side is the distance threshold, so
+ * neighbors of an instance can only lie in its own cell or the 8 surrounding ones.
+ *
+ * The grid is hierarchical: only occupied cells are stored (in a hash map keyed by
+ * cell coordinates), so memory scales with the occupied area rather than the bounding
+ * box, and every cell holding more than a few dozen instances is subdivided into a
+ * quadtree. Cell pairs are then joined node against node, skipping any pair of nodes
+ * whose bounding boxes are farther apart than the threshold, which keeps dense cells
+ * from degenerating into a quadratic all-pairs comparison.
  */
 class SpatialIndex {
 private:
+    /**
+     * @brief Node of the quadtree built inside a grid cell
+     *
+     * A node covers a contiguous range of `order`; its children (if any) partition
+     * that range into up to four quadrants.
+     */
+    struct QuadNode {
+        double minX, minY, maxX, maxY;  ///< Tight bounding box of the node's instances
+        uint32_t begin, end;            ///< Range of the node's instances in `order`
+        int32_t firstChild;             ///< Index of the first child in `nodes`, -1 for a leaf
+        uint32_t childCount;            ///< Number of (consecutive) children
+    };
+
+    static constexpr uint32_t kLeafCapacity = 32;  ///< Cells/nodes larger than this are subdivided
+    static constexpr int kMaxDepth = 12;          ///< Subdivision depth limit (guards duplicate points)
+
     double distanceThreshold;  ///< Distance threshold for neighbor determination
 
+    const std::vector<SpatialInstance>* indexed = nullptr;  ///< Instances the index was built over
+    std::unordered_map<uint64_t, uint32_t> cellRoots;        ///< Occupied cell key -> root node index
+    std::vector<uint64_t> cellKeys;                          ///< Occupied cell keys, in ascending order
+    std::vector<QuadNode> nodes;                             ///< Quadtree nodes of all cells
+    std::vector<uint32_t> order;                             ///< Instance indices, grouped by cell and node
+
     /**
      * @brief Calculate Euclidean distance between two spatial instances
-     * 
+     *
      * @param a First spatial instance
      * @param b Second spatial instance
      * @return double Euclidean distance between a and b
      */
-    double euclideanDist(const SpatialInstance& a, const SpatialInstance& b);
-    
+    double euclideanDist(const SpatialInstance& a, const SpatialInstance& b) const;
+
+    /**
+     * @brief Pack integer cell coordinates into a hash key
+     */
+    static uint64_t cellKey(int64_t cx, int64_t cy);
+
+    /**
+     * @brief Recursively build the quadtree below a node covering order[begin, end)
+     *
+     * @param node Index of the (already allocated) node in `nodes`
+     * @param begin First position in `order` covered by the node
+     * @param end One past the last position in `order` covered by the node
+     * @param depth Depth of the node below the cell root
+     */
+    void buildNode(uint32_t node, uint32_t begin, uint32_t end, int depth);
+
+    /**
+     * @brief Squared minimum distance between the bounding boxes of two nodes
+     */
+    static double nodeDist2(const QuadNode& a, const QuadNode& b);
+
+    /**
+     * @brief Collect neighbor pairs between two quadtree nodes
+     *
+     * @param a Index of the first node
+     * @param b Index of the second node
+     * @param same True if a and b are the same node (each pair is emitted once)
+     * @param pairs Output vector of neighbor pairs
+     */
+    void joinNodes(uint32_t a, uint32_t b, bool same,
+                   std::vector<std::pair<SpatialInstance, SpatialInstance>>& pairs);
+
+    /**
+     * @brief Collect the instances of a quadtree node lying within the threshold of a center
+     *
+     * Only neighbors with a greater feature code than the center are kept.
+     *
+     * @param node Index of the node to search
+     * @param center Center instance
+     * @param out Output vector of instance indices
+     */
+    void queryNode(uint32_t node, const SpatialInstance& center, std::vector<uint32_t>& out) const;
+
+    /**
+     * @brief Collect the instances of a quadtree node lying inside a rectangle
+     *
+     * @param node Index of the node to search
+     * @param minX, minY, maxX, maxY Rectangle, bounds included
+     * @param out Output vector of instance indices
+     */
+    void queryBoxNode(uint32_t node, double minX, double minY, double maxX, double maxY,
+                      std::vector<uint32_t>& out) const;
+
+    /**
+     * @brief Collect the star neighbors of one instance, sorted by (feature code, index)
+     *
+     * @param center Index of the center instance
+     * @param out Output vector of instance indices (cleared first)
+     */
+    void collectStarNeighbors(uint32_t center, std::vector<uint32_t>& out) const;
+
 public:
     /**
      * @brief Constructor to initialize SpatialIndex with a distance threshold
-     * 
+     *
      * @param distThresh Maximum distance for two instances to be considered neighbors
      */
     SpatialIndex(double distThresh);
 
+    /**
+     * @brief Bucket instances into occupied cells and build each cell's quadtree
+     *
+     * findNeighborPair() and findStarNeighbors() build the index themselves; call
+     * this only to range-query instances whose neighbors came from elsewhere (e.g.
+     * a checkpoint).
+     *
+     * @param instances Vector of all spatial instances to index; must outlive the index
+     */
+    void build(const std::vector<SpatialInstance>& instances);
+
+    /**
+     * @brief Find the instances inside a rectangle
+     *
+     * Visits only the occupied grid cells the rectangle overlaps, and inside them
+     * only the quadtree nodes whose bounding box meets it, so the cost follows the
+     * size of the answer rather than of the dataset.
+     *
+     * @param minX, minY, maxX, maxY Rectangle, bounds included
+     * @param out Output: positions of the instances inside, in ascending order (cleared first)
+     * @throws std::logic_error If the index has not been built
+     */
+    void queryBox(double minX, double minY, double maxX, double maxY, std::vector<uint32_t>& out) const;
+
     /**
      * @brief Find all neighbor pairs within the distance threshold
-     * 
-     * Uses brute-force comparison (O(n²)) to find all pairs of instances
-     * that are within the specified distance threshold.
-     * 
+     *
+     * Builds the hierarchical grid over the instances and joins every occupied cell
+     * with itself and its forward neighbor cells, so each pair is found once. Pairs of
+     * instances with the same feature type are not reported.
+     *
      * @param instances Vector of all spatial instances to search
-     * @return std::vector<std::pair<SpatialInstance, SpatialInstance>> Vector of neighbor pairs
-     * @note Time complexity: O(n²) where n is the number of instances
+     * @return std::vector<std::pair<SpatialInstance, SpatialInstance>> Vector of neighbor pairs,
+     *         each ordered by (feature type, instance ID)
      */
     std::vector<std::pair<SpatialInstance, SpatialInstance>> findNeighborPair(const std::vector<SpatialInstance>& instances);
-};
\ No newline at end of file
+
+    /**
+     * @brief Find the star neighbors of every instance, in compressed sparse row form
+     *
+     * The star neighbors of an instance are its neighbors with a greater feature code
+     * (the same canonical order findNeighborPair() uses), sorted by feature code and
+     * then by instance position. Blocks of centers are searched in parallel, each
+     * center once, into per-block buffers that are then copied into place; no
+     * neighbor pair is ever materialized.
+     *
+     * @param instances Vector of all spatial instances to search
+     * @param offsets Output: star neighbors of instance i are neighbors[offsets[i], offsets[i+1])
+     * @param neighbors Output: concatenated star neighbor indices
+     */
+    void findStarNeighbors(const std::vector<SpatialInstance>& instances,
+                           std::vector<size_t>& offsets,
+                           std::vector<uint32_t>& neighbors);
+};
@@ -0,0 +1,43 @@
+/**
+ * @file spatial_order.h
+ * @brief Space-filling-curve reordering of spatial instances
+ */
+
+#pragma once
+#include "types.h"
+#include <string>
+#include <vector>
+
+/**
+ * @brief Order in which instances are laid out in memory after loading
+ */
+enum class SpatialOrder {
+    None,     ///< Keep the order of the input file
+    Morton,   ///< Z-order curve over quantized coordinates
+    Hilbert   ///< Hilbert curve over quantized coordinates
+};
+
+/**
+ * @brief Parse a spatial order name ("none", "morton" or "hilbert")
+ *
+ * @param name Name as written in the configuration file
+ * @return SpatialOrder Parsed order
+ * @throws std::invalid_argument If the name is not one of the above
+ */
+SpatialOrder parseSpatialOrder(const std::string& name);
+
+/**
+ * @brief Reorder instances along a space-filling curve
+ *
+ * Coordinates are quantized to a 65536 x 65536 grid over the bounding box, mapped to a
+ * 32-bit Morton or Hilbert key, and the instances are sorted by key with a parallel LSD
+ * radix sort. Instances that are close in space end up close in memory, which gives
+ * neighbor search, star scans and participation bitmaps spatial locality.
+ *
+ * Positions change, so feature codes and per-feature indices must be (re)assigned
+ * afterwards with assignFeatureCodes().
+ *
+ * @param instances Vector of spatial instances to reorder in place
+ * @param order Curve to sort along; SpatialOrder::None leaves the vector untouched
+ */
+void reorderInstances(std::vector<SpatialInstance>& instances, SpatialOrder order);
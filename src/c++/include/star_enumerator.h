@@ -0,0 +1,80 @@
+/**
+ * @file star_enumerator.h
+ * @brief Iterative enumeration of star instances inside one star neighborhood
+ */
+
+#pragma once
+#include "types.h"
+#include "pattern.h"
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief StarEnumerator class for enumerating the star instances of a candidate pattern
+ *
+ * A star instance of pattern {C, F1, ..., Fk-1} in a star centered on a C instance is
+ * the center plus one neighbor of each feature Fi. Since star neighbors are grouped by
+ * feature, the instances are the Cartesian product of k-1 contiguous neighbor ranges,
+ * which this class walks with an odometer instead of recursion.
+ *
+ * An enumerator is bound to one (star, pattern) pair at a time and keeps its cursor
+ * buffers across bindings, so a single object can be reused for every star of a level
+ * without allocating.
+ */
+class StarEnumerator {
+private:
+    const StarNeighborhood* star = nullptr;  ///< Currently bound star
+    size_t width = 0;                        ///< Pattern size k
+    std::vector<uint32_t> rangeBegin;        ///< Per slot: first neighbor offset (slot 0 is the center)
+    std::vector<uint32_t> rangeEnd;          ///< Per slot: one past the last neighbor offset
+    std::vector<uint32_t> cursor;            ///< Per slot: odometer position
+
+    /**
+     * @brief emit() for a pattern size known at compile time (K = 0: use `width`)
+     */
+    template <size_t K>
+    size_t emitRows(std::vector<const SpatialInstance*>& out);
+
+public:
+    /**
+     * @brief Bind the enumerator to a star and a candidate pattern
+     *
+     * Resolves the neighbor range of every non-center feature of the pattern and stops
+     * at the first feature the star has no neighbor of.
+     *
+     * @param star Star neighborhood whose center has feature pattern[0]
+     * @param pattern Feature codes of the candidate pattern, center feature first
+     * @return bool False if the star contains no instance of the pattern
+     */
+    bool bind(const StarNeighborhood& star, const Pattern& pattern);
+
+    /**
+     * @brief Number of star instances of the bound pattern (product of the range sizes)
+     *
+     * @return uint64_t Instance count
+     */
+    uint64_t count() const;
+
+    /**
+     * @brief Append every star instance of the bound pattern to a flat row buffer
+     *
+     * Rows of k instance pointers are written back to back, center first, in the order
+     * the previous recursive enumeration produced them. Sizes 2 to 5 run a kernel
+     * specialized for k.
+     *
+     * @param out Flat output buffer
+     * @return size_t Number of rows appended
+     */
+    size_t emit(std::vector<const SpatialInstance*>& out);
+
+    /**
+     * @brief Mark the instances that take part in at least one star instance
+     *
+     * For a bound pattern the center and every neighbor of a required feature
+     * participate, so no instance needs to be enumerated.
+     *
+     * @param slots Array of k participation bitmaps, one per pattern slot, indexed
+     *        by SpatialInstance::featureIndex
+     */
+    void markParticipants(ParticipationBitmap* slots) const;
+};
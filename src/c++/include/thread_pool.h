@@ -0,0 +1,55 @@
+/**
+ * @file thread_pool.h
+ * @brief Fixed pool of worker threads serving a task queue
+ */
+
+#pragma once
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief ThreadPool class running submitted tasks on a fixed set of threads
+ *
+ * Tasks run in submission order as workers become free. Destroying the pool
+ * finishes the queued tasks and joins the workers.
+ */
+class ThreadPool {
+private:
+    std::vector<std::thread> workers;          ///< Worker threads
+    std::deque<std::function<void()>> tasks;   ///< Tasks not started yet
+    std::mutex mutex;                          ///< Guards `tasks` and `stopping`
+    std::condition_variable wakeup;            ///< Signalled when a task is queued or the pool stops
+    bool stopping = false;                     ///< Set once the pool is being destroyed
+
+    /**
+     * @brief Body of each worker: run tasks until the pool stops and the queue is empty
+     */
+    void workerLoop();
+
+public:
+    /**
+     * @brief Start the worker threads
+     *
+     * @param threads Number of workers (at least one is started)
+     */
+    explicit ThreadPool(size_t threads);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /**
+     * @brief Queue a task
+     *
+     * @param task Function to run on a worker; exceptions escaping it are discarded
+     */
+    void submit(std::function<void()> task);
+
+    /** @brief Number of worker threads */
+    size_t size() const { return workers.size(); }
+};
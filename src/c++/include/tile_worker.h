@@ -0,0 +1,74 @@
+/**
+ * @file tile_worker.h
+ * @brief Neighborhoods and participant search of one tile of a partitioned dataset
+ */
+
+#pragma once
+#include "types.h"
+#include "pattern.h"
+#include "neighborhood_mgr.h"
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief TileWorker class mining the participants of candidate patterns inside one tile
+ *
+ * A tile holds the instances of a rectangle of the plane (its core) plus every
+ * instance within one neighbor distance of it (its halo). A clique instance is
+ * owned by the tile whose core holds its center, i.e. its first member: all other
+ * members are neighbors of the center, so they lie in the core or the halo, and
+ * every clique instance of the dataset is found by exactly one tile.
+ *
+ * Instances are renumbered inside the tile so its star lookup stays proportional
+ * to the tile, and participants are reported with their feature index in the
+ * whole dataset, ready to be ORed into global participation bitmaps.
+ */
+class TileWorker {
+private:
+    std::vector<SpatialInstance> instances;   ///< Core and halo instances, with tile-local feature indices
+    std::vector<std::vector<uint32_t>> globalIndex;  ///< Per feature code: dataset feature index of each tile-local one
+    std::vector<char> owned;                  ///< Per instance: true if it lies in the tile core
+    std::vector<size_t> localSizes;           ///< Per feature code: number of instances in the tile
+    NeighborhoodMgr neighborhoods;            ///< Star neighborhoods of the tile
+    std::vector<const std::vector<StarNeighborhood>*> starsByFeature;  ///< Stars of each feature code
+
+    /**
+     * @brief Enumerate the cliques of one star slot by slot, marking their members
+     *
+     * @param pattern Feature codes of the pattern, center feature first
+     * @param groups Neighbor range of each non-center slot inside the star
+     * @param star Star being searched
+     * @param depth Slot to fill next
+     * @param chosen Members chosen for slots [1, depth)
+     * @param slots Tile-local participation bitmaps, one per slot
+     * @return bool True if at least one clique was completed
+     */
+    bool markCliques(const Pattern& pattern, const NeighborGroup* const* groups,
+                     const StarNeighborhood& star, size_t depth,
+                     const SpatialInstance** chosen, ParticipationBitmap* slots) const;
+
+public:
+    /**
+     * @brief Build the star neighborhoods of a tile
+     *
+     * @param tileInstances Core and halo instances, in dataset order, carrying the
+     *        dataset's feature codes and feature indices
+     * @param ownedFlags Per instance: true if it lies in the tile core
+     * @param distance Neighbor distance threshold
+     * @param numFeatures Number of feature codes of the dataset
+     */
+    TileWorker(std::vector<SpatialInstance> tileInstances, std::vector<char> ownedFlags,
+               double distance, size_t numFeatures);
+
+    TileWorker(const TileWorker&) = delete;
+    TileWorker& operator=(const TileWorker&) = delete;
+
+    /**
+     * @brief Collect the participants of the clique instances the tile owns
+     *
+     * @param pattern Feature codes of the candidate, in ascending order
+     * @param participants Per slot: dataset feature indices of the participants
+     *        are appended (each at most once per tile)
+     */
+    void collectParticipants(const Pattern& pattern, std::vector<std::vector<uint32_t>>& participants) const;
+};
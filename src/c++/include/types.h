@@ -7,6 +7,9 @@
  */
 
 #pragma once
+#include <algorithm>
+#include <bitset>
+#include <cstdint>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -18,10 +21,16 @@
 /** @brief Type alias for feature types (e.g., "Restaurant", "Hotel") */
 using FeatureType = std::string;
 
+/** @brief Dense integer code of a feature type (its index in the sorted list of feature types) */
+using FeatureCode = uint32_t;
+
+/** @brief Dense identifier of a candidate pattern within one level (see PatternRegistry) */
+using PatternId = uint32_t;
+
 /** @brief Type alias for instance identifiers (e.g., "A1", "B2") */
 using instanceID = std::string;
 
-/** @brief Type alias for a colocation pattern (set of feature types) */
+/** @brief Type alias for a colocation pattern (set of feature types); the miner works on Pattern internally */
 using Colocation = std::vector<FeatureType>;
 
 /** @brief Type alias for a colocation instance (set of spatial instance pointers) */
@@ -43,6 +52,72 @@ struct SpatialInstance {
     FeatureType type;  ///< Feature type of this instance (e.g., "A", "B")
     instanceID id;     ///< Unique identifier (e.g., "A1", "B2")
     double x, y;       ///< 2D spatial coordinates
+    FeatureCode feature = 0;  ///< Dense code of `type`, set by assignFeatureCodes()
+    uint32_t featureIndex = 0;  ///< Position among the instances of the same feature, set by assignFeatureCodes()
+};
+
+/**
+ * @brief Spatial instance observed at a point in time (e.g. a check-in)
+ */
+struct SpatialEvent {
+    SpatialInstance instance;  ///< Observed instance
+    double timestamp;          ///< Observation time, in the dataset's time unit
+};
+
+/**
+ * @brief Read-only view over a contiguous array (a minimal stand-in for C++20 std::span)
+ */
+template <typename T>
+struct Span {
+    const T* first = nullptr;  ///< First element
+    size_t count = 0;          ///< Number of elements
+
+    const T* data() const { return first; }
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    const T* begin() const { return first; }
+    const T* end() const { return first + count; }
+    const T& operator[](size_t i) const { return first[i]; }
+};
+
+/**
+ * @brief Contiguous run of same-feature neighbors inside a star neighborhood
+ *
+ * Offsets index into StarNeighborhood::neighbors.
+ */
+struct NeighborGroup {
+    FeatureCode feature;  ///< Feature code shared by every neighbor in the run
+    uint32_t begin;       ///< Offset of the first neighbor of this feature
+    uint32_t end;         ///< One past the offset of the last neighbor of this feature
+};
+
+/**
+ * @brief Fixed-size bit set of feature codes
+ *
+ * Holds the features present in a star (or required by a candidate) as a 256-bit
+ * mask, so a star lacking one of a candidate's features is rejected with a few
+ * word-wise ANDs. Codes at or above kCapacity are not representable; patterns
+ * involving them fall back to the star's sorted group list.
+ */
+struct FeatureMask {
+    static constexpr size_t kWords = 4;                                      ///< 64-bit words in the mask
+    static constexpr FeatureCode kCapacity = static_cast<FeatureCode>(kWords * 64);  ///< Number of representable codes
+
+    uint64_t words[kWords] = {};  ///< Bit f is set if feature f is present
+
+    /** @brief Mark feature f as present (ignored if f is not representable) */
+    void set(FeatureCode f) {
+        if (f < kCapacity) words[f >> 6] |= uint64_t(1) << (f & 63);
+    }
+
+    /** @brief True if every feature of `required` is also present in this mask */
+    bool contains(const FeatureMask& required) const {
+        uint64_t missing = 0;
+        for (size_t w = 0; w < kWords; ++w) {
+            missing |= required.words[w] & ~words[w];
+        }
+        return missing == 0;
+    }
 };
 
 /**
@@ -50,8 +125,117 @@ struct SpatialInstance {
  * 
  * A star neighborhood consists of a center instance and all its neighboring instances
  * within the distance threshold. This is a key concept in the joinless algorithm.
+ *
+ * Neighbors are kept sorted by feature code, then by feature index, and `groups`
+ * records where each feature's run starts and ends, so the neighbors of one feature can
+ * be looked up without building any per-star map. Both arrays are views into storage
+ * shared by all stars and owned by the NeighborhoodMgr.
  */
 struct StarNeighborhood {
     const SpatialInstance* center;                      ///< Center instance of the star
-    std::vector<const SpatialInstance*> neighbors;      ///< All neighbors within distance threshold
+    Span<const SpatialInstance*> neighbors;             ///< All neighbors within distance threshold
+    Span<NeighborGroup> groups;                         ///< One entry per neighbor feature, sorted by feature
+    FeatureMask presence;                               ///< Features present among the neighbors
+
+    /**
+     * @brief Find the run of neighbors having a given feature
+     *
+     * @param feature Feature code to look up
+     * @return const NeighborGroup* The matching group, or nullptr if the star has no such neighbor
+     */
+    const NeighborGroup* findGroup(FeatureCode feature) const {
+        auto it = std::lower_bound(groups.begin(), groups.end(), feature,
+            [](const NeighborGroup& g, FeatureCode f) { return g.feature < f; });
+        return (it != groups.end() && it->feature == feature) ? &*it : nullptr;
+    }
+};
+
+/**
+ * @brief Flat table of colocation instances that all have the same size
+ *
+ * Rows of `width` instance pointers are stored back to back in one buffer, so a
+ * level's star or clique instances cost a handful of allocations instead of one
+ * per instance. Each row also records the ID of its pattern in the level's
+ * PatternRegistry, so its pattern never has to be rebuilt from instance types.
+ */
+struct InstanceTable {
+    size_t width = 0;                                   ///< Instances per row (pattern size k)
+    std::vector<const SpatialInstance*> cells;          ///< Row-major instance pointers
+    std::vector<PatternId> patterns;                    ///< Pattern ID of each row
+
+    /** @brief Number of rows in the table */
+    size_t rows() const { return width == 0 ? 0 : cells.size() / width; }
+
+    /** @brief Pointer to the first instance of row r */
+    const SpatialInstance* const* row(size_t r) const { return cells.data() + r * width; }
+};
+
+/**
+ * @brief Set of participating instances of one feature, as a bitmap over featureIndex
+ *
+ * Keeps a running count of set bits so participation ratios need no extra pass.
+ * Only bits below `counted` enter the count: when mining a region, the instances
+ * of its halo follow the in-region ones and may complete cliques without being
+ * counted as participants.
+ */
+struct ParticipationBitmap {
+    std::vector<uint64_t> words;  ///< One bit per instance of the feature
+    size_t count = 0;             ///< Number of counted bits set
+    size_t counted = 0;           ///< Bits [0, counted) are counted
+
+    /** @brief Clear the bitmap and size it for `bits` instances, reusing its storage */
+    void reset(size_t bits) {
+        reset(bits, bits);
+    }
+
+    /** @brief Clear the bitmap, size it for `bits` instances and count the first `countedBits` */
+    void reset(size_t bits, size_t countedBits) {
+        words.assign((bits + 63) / 64, 0);
+        count = 0;
+        counted = countedBits;
+    }
+
+    /** @brief Mark instance i as participating */
+    void set(uint32_t i) {
+        uint64_t bit = uint64_t(1) << (i & 63);
+        uint64_t& word = words[i >> 6];
+        count += ((word & bit) == 0) & (i < counted);
+        word |= bit;
+    }
+
+    /** @brief Enlarge the bitmap to `bits` instances, all counted, keeping its participants */
+    void grow(size_t bits) {
+        if (words.size() < (bits + 63) / 64) {
+            words.resize((bits + 63) / 64, 0);
+        }
+        counted = std::max(counted, bits);
+    }
+
+    /** @brief Check whether instance i participates */
+    bool test(uint32_t i) const {
+        return (words[i >> 6] >> (i & 63)) & 1;
+    }
+
+    /** @brief Mark instance i as not participating */
+    void unset(uint32_t i) {
+        uint64_t bit = uint64_t(1) << (i & 63);
+        uint64_t& word = words[i >> 6];
+        count -= ((word & bit) != 0) & (i < counted);
+        word &= ~bit;
+    }
+
+    /** @brief Add the participants of another bitmap of the same feature */
+    void merge(const ParticipationBitmap& other) {
+        count = 0;
+        for (size_t w = 0; w < words.size(); ++w) {
+            words[w] |= other.words[w];
+            uint64_t mask = ~uint64_t(0);
+            if (w * 64 >= counted) {
+                mask = 0;
+            } else if (counted - w * 64 < 64) {
+                mask = (uint64_t(1) << (counted - w * 64)) - 1;
+            }
+            count += std::bitset<64>(words[w] & mask).count();
+        }
+    }
 };
\ No newline at end of file
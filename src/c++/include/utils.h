@@ -22,6 +22,18 @@
  */
 std::vector<FeatureType> getAllObjectTypes(const std::vector<SpatialInstance>& instances);
 
+/**
+ * @brief Assign dense feature codes to spatial instances
+ *
+ * Sets SpatialInstance::feature to the index of the instance's type in the sorted
+ * list of feature types, so codes follow the same order as getAllObjectTypes(), and
+ * SpatialInstance::featureIndex to the instance's position among its feature's instances.
+ *
+ * @param instances Vector of spatial instances to encode in place
+ * @return std::vector<FeatureType> Sorted feature types; position i holds the name of code i
+ */
+std::vector<FeatureType> assignFeatureCodes(std::vector<SpatialInstance>& instances);
+
 /**
  * @brief Count the number of instances for each feature type
  * 
@@ -46,24 +58,6 @@ SpatialInstance getInstanceByID(
     const std::vector<SpatialInstance>& instances, 
     const instanceID& id);
 
-/**
-* @brief Recursive helper to find all combinations of spatial instances
-*        matching a candidate pattern within a star neighborhood.
-* 
-* @param candidatePattern The candidate colocation pattern being matched
-* @param typeIndex Current index in the candidate pattern being processed
-* @param currentInstance Current partial instance being built
-* @param neighborMap Map of feature types to their neighboring instances
-* @param results Vector to store the resulting colocation instances
-*/
-void findCombinations(
-    const std::vector<FeatureType>& candidatePattern,
-    int typeIndex,
-    std::vector<const SpatialInstance*>& currentInstance,
-    const std::unordered_map<FeatureType, std::vector<const SpatialInstance*>>& neighborMap,
-    std::vector<ColocationInstance>& results);
-
-
 /**
 * @brief Print the duration of a processing step
 * 
@@ -77,8 +71,19 @@ void printDuration(const std::string& stepName, std::chrono::high_resolution_clo
 /**
  * @brief Get current memory usage in megabytes
  *
- * Uses Windows API to retrieve the current process's memory usage.
+ * Uses the Windows API to retrieve the current process's working set; elsewhere
+ * reads the resident set from /proc, and returns 0 where that is unavailable.
  *
  * @return double Memory usage in MB
  */
-double getMemoryUsageMB();
\ No newline at end of file
+double getMemoryUsageMB();
+
+/**
+ * @brief Get the peak memory usage of the process in megabytes
+ *
+ * Uses the Windows API to retrieve the peak working set; elsewhere reads the
+ * peak resident set (VmHWM) from /proc, and returns 0 where that is unavailable.
+ *
+ * @return double Peak memory usage in MB
+ */
+double getPeakMemoryUsageMB();
\ No newline at end of file
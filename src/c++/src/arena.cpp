@@ -0,0 +1,30 @@
+/**
+ * @file arena.cpp
+ * @brief Implementation of the per-level scratch memory arena
+ */
+
+#include "arena.h"
+#include <omp.h>
+
+LevelArena::LevelArena(size_t initialBytes) {
+    int num_threads = omp_get_max_threads();
+    threadResources.reserve(num_threads);
+    for (int i = 0; i < num_threads; ++i) {
+        threadResources.push_back(std::make_unique<std::pmr::monotonic_buffer_resource>(
+            initialBytes, std::pmr::new_delete_resource()));
+    }
+}
+
+std::pmr::memory_resource* LevelArena::resource(int threadId) {
+    return threadResources[threadId].get();
+}
+
+std::pmr::memory_resource* LevelArena::local() {
+    return resource(omp_get_thread_num());
+}
+
+void LevelArena::release() {
+    for (auto& res : threadResources) {
+        res->release();
+    }
+}
@@ -0,0 +1,259 @@
+/**
+ * @file checkpoint_store.cpp
+ * @brief Implementation of the mining checkpoint files
+ */
+
+#include "checkpoint_store.h"
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+namespace {
+
+constexpr size_t kSections = 4;             // Arrays per file
+constexpr size_t kTupleBlock = 1 << 14;     // Tuples requested from a TupleSource at once
+constexpr char kLevelMagic[8] = {'J', 'L', 'L', 'E', 'V', 'E', 'L', '1'};
+constexpr char kGraphMagic[8] = {'J', 'L', 'G', 'R', 'A', 'P', 'H', '1'};
+
+// Level file arrays
+enum LevelSection { kPrevalentSizes = 0, kPrevalentCodes = 1, kCandidateCodes = 2, kCliqueTuples = 3 };
+// Graph file arrays
+enum GraphSection { kGraphOffsets = 0, kGraphNeighbors = 1 };
+
+struct FileHeader {
+    char magic[8];
+    uint64_t key;                  // Fingerprint of the run or graph
+    uint64_t level;                // Completed level (level files)
+    uint64_t tupleWidth;           // Words per clique tuple (level files)
+    uint64_t offsets[kSections];   // Byte offset of each array
+    uint64_t counts[kSections];    // Elements in each array
+};
+
+uint64_t mix(uint64_t h, uint64_t value) {
+    for (int byte = 0; byte < 8; ++byte) {
+        h = (h ^ ((value >> (8 * byte)) & 0xFF)) * 0x100000001b3ull;
+    }
+    return h;
+}
+
+uint64_t mix(uint64_t h, const std::string& text) {
+    for (unsigned char c : text) h = (h ^ c) * 0x100000001b3ull;
+    return mix(h, text.size());
+}
+
+uint64_t bitsOf(double value) {
+    uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+/**
+ * Writes the arrays of one checkpoint file behind a header that is filled in last
+ */
+class SectionWriter {
+private:
+    std::string finalPath;
+    std::string tempPath;
+    std::ofstream out;
+    FileHeader header{};
+    uint64_t position = sizeof(FileHeader);
+
+public:
+    SectionWriter(const std::string& path, const char (&magic)[8], uint64_t key)
+        : finalPath(path), tempPath(path + ".tmp")
+    {
+        std::filesystem::path dir = std::filesystem::path(path).parent_path();
+        if (!dir.empty()) std::filesystem::create_directories(dir);
+
+        out.open(tempPath, std::ios::binary | std::ios::trunc);
+        if (!out.is_open()) {
+            throw std::runtime_error("Cannot create checkpoint file " + tempPath);
+        }
+        std::memcpy(header.magic, magic, sizeof(header.magic));
+        header.key = key;
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    }
+
+    FileHeader& fields() { return header; }
+
+    // Start an array at the next 8-byte boundary
+    void begin(size_t section) {
+        static const char zeros[8] = {};
+        size_t pad = static_cast<size_t>((8 - position % 8) % 8);
+        out.write(zeros, pad);
+        position += pad;
+        header.offsets[section] = position;
+        header.counts[section] = 0;
+    }
+
+    template <typename T>
+    void append(size_t section, const T* values, size_t count) {
+        out.write(reinterpret_cast<const char*>(values), count * sizeof(T));
+        position += count * sizeof(T);
+        header.counts[section] += count;
+    }
+
+    // Fill in the header and move the file into place
+    void commit() {
+        out.seekp(0);
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.close();
+        if (!out) {
+            throw std::runtime_error("Cannot write checkpoint file " + tempPath);
+        }
+        std::filesystem::rename(tempPath, finalPath);
+    }
+};
+
+// Map a checkpoint file; nullptr if it is missing or was written for another run
+std::shared_ptr<const MappedFile> openChecked(const std::string& path, const char (&magic)[8],
+                                              uint64_t key, FileHeader& header) {
+    std::error_code ignored;
+    if (!std::filesystem::exists(path, ignored)) return nullptr;
+
+    auto file = std::make_shared<const MappedFile>(path);
+    if (file->size() < sizeof(FileHeader)) return nullptr;
+    std::memcpy(&header, file->data(), sizeof(header));
+    if (std::memcmp(header.magic, magic, sizeof(header.magic)) != 0 || header.key != key) {
+        return nullptr;
+    }
+    return file;
+}
+
+} // namespace
+
+
+CheckpointStore::CheckpointStore(const std::string& dir) : directory(dir) {}
+
+std::string CheckpointStore::levelPath() const {
+    return (std::filesystem::path(directory) / "level.ckpt").string();
+}
+
+std::string CheckpointStore::graphPath() const {
+    return (std::filesystem::path(directory) / "neighbors.graph").string();
+}
+
+
+uint64_t CheckpointStore::fingerprint(const std::vector<SpatialInstance>& instances, double distance) {
+    uint64_t h = 0xcbf29ce484222325ull;
+    h = mix(h, instances.size());
+    for (const auto& instance : instances) {
+        h = mix(h, instance.type);
+        h = mix(h, instance.id);
+        h = mix(h, bitsOf(instance.x));
+        h = mix(h, bitsOf(instance.y));
+    }
+    return mix(h, bitsOf(distance));
+}
+
+uint64_t CheckpointStore::fingerprint(uint64_t base, double value) {
+    return mix(base, bitsOf(value));
+}
+
+uint64_t CheckpointStore::fingerprint(uint64_t base, const std::string& value) {
+    return mix(base, value);
+}
+
+
+void CheckpointStore::saveNeighborGraph(uint64_t key, const std::vector<size_t>& offsets,
+                                        const std::vector<uint32_t>& neighbors) const {
+    SectionWriter writer(graphPath(), kGraphMagic, key);
+
+    std::vector<uint64_t> wide(offsets.begin(), offsets.end());
+    writer.begin(kGraphOffsets);
+    writer.append(kGraphOffsets, wide.data(), wide.size());
+    writer.begin(kGraphNeighbors);
+    writer.append(kGraphNeighbors, neighbors.data(), neighbors.size());
+    writer.commit();
+}
+
+
+bool CheckpointStore::loadNeighborGraph(uint64_t key, size_t numInstances, std::vector<size_t>& offsets,
+                                        std::vector<uint32_t>& neighbors) const {
+    FileHeader header;
+    auto file = openChecked(graphPath(), kGraphMagic, key, header);
+    if (file == nullptr) return false;
+
+    Span<uint64_t> storedOffsets = file->array<uint64_t>(header.offsets[kGraphOffsets], header.counts[kGraphOffsets]);
+    Span<uint32_t> storedNeighbors = file->array<uint32_t>(header.offsets[kGraphNeighbors], header.counts[kGraphNeighbors]);
+    if (storedOffsets.size() != numInstances + 1 || storedOffsets[numInstances] != storedNeighbors.size()) {
+        return false;
+    }
+
+    offsets.assign(storedOffsets.begin(), storedOffsets.end());
+    neighbors.assign(storedNeighbors.begin(), storedNeighbors.end());
+    return true;
+}
+
+
+void CheckpointStore::saveLevel(uint64_t key, uint32_t level, const std::vector<Pattern>& prevalent,
+                                const std::vector<Pattern>& candidates, size_t tupleWidth, size_t tupleCount,
+                                const TupleSource& source) const {
+    SectionWriter writer(levelPath(), kLevelMagic, key);
+    writer.fields().level = level;
+    writer.fields().tupleWidth = tupleWidth;
+
+    writer.begin(kPrevalentSizes);
+    for (const auto& pattern : prevalent) {
+        uint32_t size = static_cast<uint32_t>(pattern.size());
+        writer.append(kPrevalentSizes, &size, 1);
+    }
+    writer.begin(kPrevalentCodes);
+    for (const auto& pattern : prevalent) {
+        writer.append(kPrevalentCodes, pattern.data(), pattern.size());
+    }
+    writer.begin(kCandidateCodes);
+    for (const auto& pattern : candidates) {
+        writer.append(kCandidateCodes, pattern.data(), pattern.size());
+    }
+
+    writer.begin(kCliqueTuples);
+    if (tupleWidth > 0) {
+        std::vector<uint32_t> block(kTupleBlock * tupleWidth);
+        size_t written = 0;
+        while (size_t n = source(block.data(), kTupleBlock)) {
+            writer.append(kCliqueTuples, block.data(), n * tupleWidth);
+            written += n;
+        }
+        if (written != tupleCount) {
+            throw std::logic_error("CheckpointStore::saveLevel: tuple source ended early");
+        }
+    }
+    writer.commit();
+}
+
+
+bool CheckpointStore::loadLevel(uint64_t key, LevelState& state) const {
+    FileHeader header;
+    auto file = openChecked(levelPath(), kLevelMagic, key, header);
+    if (file == nullptr) return false;
+
+    uint32_t level = static_cast<uint32_t>(header.level);
+    Span<uint32_t> sizes = file->array<uint32_t>(header.offsets[kPrevalentSizes], header.counts[kPrevalentSizes]);
+    Span<FeatureCode> codes = file->array<FeatureCode>(header.offsets[kPrevalentCodes], header.counts[kPrevalentCodes]);
+    Span<FeatureCode> candidateCodes = file->array<FeatureCode>(header.offsets[kCandidateCodes], header.counts[kCandidateCodes]);
+    if (level < 2 || level > kMaxPatternSize || candidateCodes.size() % level != 0) return false;
+
+    state.prevalent.clear();
+    size_t next = 0;
+    for (uint32_t size : sizes) {
+        if (size > kMaxPatternSize || size > codes.size() - next) return false;
+        state.prevalent.emplace_back(codes.data() + next, size);
+        next += size;
+    }
+
+    state.candidates.clear();
+    for (size_t i = 0; i < candidateCodes.size(); i += level) {
+        state.candidates.emplace_back(candidateCodes.data() + i, level);
+    }
+
+    state.level = level;
+    state.tupleWidth = static_cast<size_t>(header.tupleWidth);
+    state.tuples = file->array<uint32_t>(header.offsets[kCliqueTuples], header.counts[kCliqueTuples]);
+    if (state.tupleWidth != 0 && (state.tupleWidth != level + 1 || state.tuples.size() % state.tupleWidth != 0)) {
+        return false;
+    }
+    state.file = std::move(file);
+    return true;
+}
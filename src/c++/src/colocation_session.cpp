@@ -0,0 +1,94 @@
+/**
+ * @file colocation_session.cpp
+ * @brief Implementation of the embeddable mining session
+ */
+
+#include "colocation_session.h"
+#include "miner.h"
+#include "spatial_index.h"
+#include "utils.h"
+#include <algorithm>
+#include <stdexcept>
+
+void ColocationSession::loadInstances(const int32_t* featureCodes, const double* x, const double* y,
+                                      const int64_t* instanceNumbers, size_t count,
+                                      const std::vector<std::string>& featureNames,
+                                      SpatialOrder order) {
+    std::vector<SpatialInstance> data(count);
+    std::vector<int64_t> nextNumber(featureNames.size(), 1);
+    for (size_t i = 0; i < count; ++i) {
+        int32_t code = featureCodes[i];
+        if (code < 0 || static_cast<size_t>(code) >= featureNames.size()) {
+            throw std::invalid_argument("Feature index " + std::to_string(code) + " of instance " +
+                                        std::to_string(i) + " is out of range");
+        }
+        int64_t number = (instanceNumbers != nullptr) ? instanceNumbers[i] : nextNumber[code]++;
+
+        data[i].type = featureNames[code];
+        data[i].id = data[i].type + std::to_string(number);
+        data[i].x = x[i];
+        data[i].y = y[i];
+    }
+    loadInstances(std::move(data), order);
+}
+
+
+void ColocationSession::loadInstances(std::vector<SpatialInstance> data, SpatialOrder order) {
+    // Stars point into the instances, so the graph goes first
+    neighborhoods.reset();
+    distance = 0.0;
+
+    instances = std::move(data);
+    reorderInstances(instances, order);
+    assignFeatureCodes(instances);
+}
+
+
+void ColocationSession::buildNeighborGraph(double distanceThreshold) {
+    if (distanceThreshold <= 0.0) {
+        throw std::invalid_argument("Neighbor distance must be positive");
+    }
+    SpatialIndex index(distanceThreshold);
+    auto graph = std::make_unique<NeighborhoodMgr>();
+    graph->buildFromIndex(instances, index);
+
+    neighborhoods = std::move(graph);
+    distance = distanceThreshold;
+}
+
+
+std::vector<Colocation> ColocationSession::mine(const MiningOptions& options) const {
+    if (neighborhoods == nullptr) {
+        throw std::logic_error("ColocationSession::mine() called before buildNeighborGraph()");
+    }
+    if (options.minPrevalence < 0.0 || options.minPrevalence > 1.0) {
+        throw std::invalid_argument("Minimum prevalence must be in [0, 1]");
+    }
+    if (options.strategy != "levelwise" && options.strategy != "depthfirst") {
+        throw std::invalid_argument("Unknown mining strategy: " + options.strategy);
+    }
+
+    JoinlessMiner miner;
+    miner.setMemoryBudget(options.memoryBudget, options.spillDir);
+    return (options.strategy == "depthfirst")
+        ? miner.mineColocationsDepthFirst(options.minPrevalence, neighborhoods.get(), instances)
+        : miner.mineColocations(options.minPrevalence, neighborhoods.get(), instances);
+}
+
+
+std::vector<double> ColocationSession::participationIndices(const std::vector<Colocation>& patterns) const {
+    if (neighborhoods == nullptr) {
+        throw std::logic_error("ColocationSession::participationIndices() called before buildNeighborGraph()");
+    }
+    std::vector<FeatureType> types = getAllObjectTypes(instances);
+    for (const auto& pattern : patterns) {
+        for (const auto& feature : pattern) {
+            if (!std::binary_search(types.begin(), types.end(), feature)) {
+                throw std::invalid_argument("Unknown feature: " + feature);
+            }
+        }
+    }
+
+    JoinlessMiner miner;
+    return miner.participationIndices(patterns, neighborhoods.get(), instances);
+}
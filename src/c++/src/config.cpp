@@ -4,9 +4,26 @@
  */
 
 #include "config.h"
+#include "spatial_order.h"
 #include <iostream>
 #include <fstream>
 #include <sstream>
+#include <stdexcept>
+
+
+// Split a comma-separated list, dropping surrounding spaces and empty entries
+static std::vector<std::string> splitList(const std::string& value) {
+    std::vector<std::string> items;
+    std::istringstream is_list(value);
+    std::string item;
+    while (std::getline(is_list, item, ',')) {
+        size_t first = item.find_first_not_of(" \t\r");
+        if (first == std::string::npos) continue;
+        size_t last = item.find_last_not_of(" \t\r");
+        items.push_back(item.substr(first, last - first + 1));
+    }
+    return items;
+}
 
 
 // Load configuration from a file
@@ -38,9 +55,37 @@ AppConfig ConfigLoader::load(const std::string& configPath) {
                 else if (key == "min_prevalence") config.minPrev = std::stod(value);
                 else if (key == "min_cond_prob") config.minCondProb = std::stod(value);
                 else if (key == "percentage_instances") config.percentageData = std::stod(value);
+                else if (key == "spatial_order") config.spatialOrder = value;
+                else if (key == "mining_strategy") config.miningStrategy = value;
+                else if (key == "partition_tiles") config.partitionTiles = std::stoi(value);
+                else if (key == "partition_workers") config.partitionWorkers = std::stoi(value);
+                else if (key == "max_memory_mb") config.maxMemoryMb = std::stod(value);
+                else if (key == "spill_dir") config.spillDir = value;
+                else if (key == "checkpoint_dir") config.checkpointDir = value;
+                else if (key == "include_features") config.includeFeatures = splitList(value);
+                else if (key == "exclude_features") config.excludeFeatures = splitList(value);
+                else if (key == "region") config.region = value;
+                else if (key == "stream_window") config.streamWindow = std::stod(value);
+                else if (key == "stream_step") config.streamStep = std::stod(value);
+                else if (key == "server_socket") config.serverSocket = value;
+                else if (key == "server_threads") config.serverThreads = std::stoi(value);
                 else if (key == "debug_mode") config.debugMode = (value == "true" || value == "1");
             }
         }
     }
+
+    // The streaming loop advances by stream_step until the events run out
+    if (config.streamWindow < 0.0) {
+        throw std::invalid_argument("stream_window must not be negative");
+    }
+    if (!(config.streamStep > 0.0)) {
+        throw std::invalid_argument("stream_step must be positive");
+    }
+    if (config.miningStrategy != "levelwise" && config.miningStrategy != "depthfirst" &&
+        config.miningStrategy != "partitioned") {
+        throw std::invalid_argument("mining_strategy must be levelwise, depthfirst or partitioned, not '" +
+                                    config.miningStrategy + "'");
+    }
+    parseSpatialOrder(config.spatialOrder);
     return config;
 };
\ No newline at end of file
@@ -4,6 +4,7 @@
  */
 
 #include "data_loader.h"
+#include "utils.h"
 #include <iostream>
 #include <algorithm>
 #include <random>
@@ -11,7 +12,7 @@
 
 using namespace csv;
 
-std::vector<SpatialInstance> DataLoader::load_csv(const std::string& filepath, double percentage) {
+std::vector<SpatialInstance> DataLoader::load_csv(const std::string& filepath, double percentage, SpatialOrder order) {
     CSVReader reader(filepath);
     auto colNames = reader.get_col_names();
     std::string xCol = "LocX";
@@ -37,6 +38,8 @@ std::vector<SpatialInstance> DataLoader::load_csv(const std::string& filepath, d
     }
 
     if (percentage >= 1.0 || percentage <= 0.0) {
+        reorderInstances(allInstances, order);
+        assignFeatureCodes(allInstances);
         return allInstances;
     }
 
@@ -71,5 +74,41 @@ std::vector<SpatialInstance> DataLoader::load_csv(const std::string& filepath, d
     std::cout << "Reduced dataset from " << allInstances.size()
         << " to " << sampledInstances.size() << " instances.\n";
 
+    reorderInstances(sampledInstances, order);
+    assignFeatureCodes(sampledInstances);
     return sampledInstances;
-}
\ No newline at end of file
+}
+
+std::vector<SpatialEvent> DataLoader::load_events(const std::string& filepath) {
+    CSVReader reader(filepath);
+    auto colNames = reader.get_col_names();
+    std::string xCol = "LocX";
+    std::string yCol = "LocY";
+    std::string timeCol = "Timestamp";
+    auto hasColumn = [&](const std::string& name) {
+        return std::find(colNames.begin(), colNames.end(), name) != colNames.end();
+        };
+
+    if (hasColumn("X")) xCol = "X";
+    if (hasColumn("Y")) yCol = "Y";
+    if (!hasColumn(timeCol) && hasColumn("Time")) timeCol = "Time";
+
+    std::vector<SpatialEvent> events;
+
+    for (auto& row : reader) {
+        SpatialEvent event;
+
+        event.instance.type = row["Feature"].get<FeatureType>();
+        event.instance.id = event.instance.type + std::to_string(row["Instance"].get<int>());
+        event.instance.x = row[xCol].get<double>();
+        event.instance.y = row[yCol].get<double>();
+        event.timestamp = row[timeCol].get<double>();
+
+        events.push_back(event);
+    }
+
+    std::stable_sort(events.begin(), events.end(), [](const SpatialEvent& a, const SpatialEvent& b) {
+        return a.timestamp < b.timestamp;
+    });
+    return events;
+}
@@ -0,0 +1,284 @@
+/**
+ * @file external_sorter.cpp
+ * @brief Implementation of the spilling tuple sorter
+ */
+
+#include "external_sorter.h"
+#include "radix_sort.h"
+#include <algorithm>
+#include <atomic>
+#include <filesystem>
+#include <random>
+#include <stdexcept>
+
+namespace {
+
+void putVarint(std::vector<uint8_t>& out, uint32_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+const uint8_t* getVarint(const uint8_t* p, uint32_t& value) {
+    value = 0;
+    for (int shift = 0;; shift += 7) {
+        uint8_t byte = *p++;
+        value |= static_cast<uint32_t>(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) return p;
+    }
+}
+
+// One compressed columnar chunk: a tuple count, then each column's byte size and varints
+void writeChunk(std::ofstream& out, const uint32_t* tuples, size_t count, size_t width, std::vector<uint8_t>& bytes) {
+    uint32_t n = static_cast<uint32_t>(count);
+    out.write(reinterpret_cast<const char*>(&n), sizeof(n));
+    for (size_t col = 0; col < width; ++col) {
+        bytes.clear();
+        uint32_t previous = 0;
+        for (size_t t = 0; t < count; ++t) {
+            uint32_t value = tuples[t * width + col];
+            putVarint(bytes, col == 0 ? value - previous : value);
+            previous = value;
+        }
+        uint32_t size = static_cast<uint32_t>(bytes.size());
+        out.write(reinterpret_cast<const char*>(&size), sizeof(size));
+        out.write(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+    }
+}
+
+// Unique run file name inside the spill directory
+std::string runPath(const std::string& directory) {
+    static const uint32_t token = std::random_device()();
+    static std::atomic<uint64_t> counter{0};
+    std::filesystem::path dir = directory.empty()
+        ? std::filesystem::temp_directory_path()
+        : std::filesystem::path(directory);
+    return (dir / ("joinless-" + std::to_string(token) + "-" + std::to_string(counter++) + ".run")).string();
+}
+
+// Removes a run file being written unless it is kept, so a failed write or
+// merge leaves nothing behind; declared before the stream, so the file is closed first
+struct RunFileGuard {
+    const std::string& path;
+    bool keep = false;
+
+    ~RunFileGuard() {
+        if (!keep) {
+            std::error_code ignored;
+            std::filesystem::remove(path, ignored);
+        }
+    }
+};
+
+} // namespace
+
+
+ExternalSorter::ExternalSorter(size_t tupleWidth, size_t budgetBytes, const std::string& spillDir)
+    : width(tupleWidth), spillDirectory(spillDir)
+{
+    // Sorting needs the tuples twice plus two words per tuple (see radixSortTuples)
+    size_t bytesPerTuple = (2 * width + 2) * sizeof(uint32_t);
+    bufferTuples = std::max<size_t>(kChunkTuples, budgetBytes / bytesPerTuple);
+}
+
+
+ExternalSorter::~ExternalSorter() {
+    for (const auto& run : runs) {
+        std::error_code ignored;
+        std::filesystem::remove(run.path, ignored);
+    }
+}
+
+
+void ExternalSorter::push(const uint32_t* tuple) {
+    buffer.insert(buffer.end(), tuple, tuple + width);
+    ++total;
+    if (buffer.size() >= bufferTuples * width) {
+        spill();
+    }
+}
+
+
+void ExternalSorter::spill() {
+    std::vector<uint32_t> order;
+    radixSortTuples(buffer, width, order);
+    std::vector<uint32_t>().swap(order);
+
+    Run run;
+    run.path = runPath(spillDirectory);
+    run.tuples = buffer.size() / width;
+    RunFileGuard guard{run.path};
+    std::ofstream out(run.path, std::ios::binary);
+    if (!out) {
+        throw std::runtime_error("Cannot create spill file " + run.path);
+    }
+
+    std::vector<uint8_t> bytes;
+    for (size_t first = 0; first < run.tuples; first += kChunkTuples) {
+        size_t count = std::min(kChunkTuples, run.tuples - first);
+        writeChunk(out, buffer.data() + first * width, count, width, bytes);
+    }
+    out.close();
+    if (!out) {
+        throw std::runtime_error("Cannot write spill file " + run.path);
+    }
+
+    guard.keep = true;
+    runs.push_back(std::move(run));
+    std::vector<uint32_t>().swap(buffer);
+}
+
+
+void ExternalSorter::mergeRuns(size_t first, size_t last) {
+    Run merged;
+    merged.path = runPath(spillDirectory);
+    RunFileGuard guard{merged.path};
+    std::ofstream out(merged.path, std::ios::binary);
+    if (!out) {
+        throw std::runtime_error("Cannot create spill file " + merged.path);
+    }
+
+    {
+        Cursor input = openRuns(first, last);
+        std::vector<uint32_t> chunk;
+        std::vector<uint8_t> bytes;
+        chunk.reserve(kChunkTuples * width);
+        while (input.valid()) {
+            chunk.insert(chunk.end(), input.tuple(), input.tuple() + width);
+            input.next();
+            if (chunk.size() == kChunkTuples * width || !input.valid()) {
+                writeChunk(out, chunk.data(), chunk.size() / width, width, bytes);
+                merged.tuples += chunk.size() / width;
+                chunk.clear();
+            }
+        }
+    }
+    out.close();
+    if (!out) {
+        throw std::runtime_error("Cannot write spill file " + merged.path);
+    }
+
+    for (size_t r = first; r < last; ++r) {
+        std::error_code ignored;
+        std::filesystem::remove(runs[r].path, ignored);
+    }
+    runs.erase(runs.begin() + first, runs.begin() + last);
+    guard.keep = true;
+    runs.push_back(std::move(merged));
+}
+
+
+void ExternalSorter::finish() {
+    if (finished) return;
+    finished = true;
+    if (runs.empty()) {
+        std::vector<uint32_t> order;
+        radixSortTuples(buffer, width, order);
+        return;
+    }
+
+    // Merge passes keep the final merge's read buffers (one chunk per run) bounded
+    if (!buffer.empty()) spill();
+    while (runs.size() > kMaxFanIn) {
+        mergeRuns(0, kMaxFanIn);
+    }
+}
+
+
+ExternalSorter::Cursor ExternalSorter::openRuns(size_t first, size_t last) const {
+    Cursor cursor;
+    cursor.width = width;
+    for (size_t r = first; r < last; ++r) {
+        Cursor::Source source;
+        source.file = std::make_unique<std::ifstream>(runs[r].path, std::ios::binary);
+        source.remaining = runs[r].tuples;
+        cursor.sources.push_back(std::move(source));
+    }
+    if (last == runs.size() && !buffer.empty()) {
+        Cursor::Source source;
+        source.data = buffer.data();
+        source.count = buffer.size() / width;
+        cursor.sources.push_back(std::move(source));
+    }
+
+    for (size_t s = 0; s < cursor.sources.size(); ++s) {
+        Cursor::Source& source = cursor.sources[s];
+        if (source.file ? cursor.loadChunk(source) : source.count > 0) {
+            cursor.heap.push_back(s);
+        }
+    }
+    auto order = [&cursor](size_t a, size_t b) { return cursor.greater(a, b); };
+    std::make_heap(cursor.heap.begin(), cursor.heap.end(), order);
+    return cursor;
+}
+
+
+ExternalSorter::Cursor ExternalSorter::cursor() const {
+    if (!finished) {
+        throw std::logic_error("ExternalSorter::cursor() called before finish()");
+    }
+    return openRuns(0, runs.size());
+}
+
+
+bool ExternalSorter::Cursor::loadChunk(Source& source) {
+    if (source.remaining == 0) return false;
+
+    uint32_t count = 0;
+    source.file->read(reinterpret_cast<char*>(&count), sizeof(count));
+    source.chunk.resize(static_cast<size_t>(count) * width);
+
+    std::vector<uint8_t> bytes;
+    for (size_t col = 0; col < width; ++col) {
+        uint32_t size = 0;
+        source.file->read(reinterpret_cast<char*>(&size), sizeof(size));
+        bytes.resize(size);
+        source.file->read(reinterpret_cast<char*>(bytes.data()), size);
+        if (!*source.file) {
+            throw std::runtime_error("Spill file is truncated");
+        }
+
+        const uint8_t* p = bytes.data();
+        uint32_t previous = 0;
+        for (size_t t = 0; t < count; ++t) {
+            uint32_t value;
+            p = getVarint(p, value);
+            if (col == 0) value += previous;
+            source.chunk[t * width + col] = value;
+            previous = value;
+        }
+    }
+
+    source.data = source.chunk.data();
+    source.count = count;
+    source.position = 0;
+    source.remaining -= count;
+    return count > 0;
+}
+
+
+bool ExternalSorter::Cursor::greater(size_t a, size_t b) const {
+    const uint32_t* ta = sources[a].data + sources[a].position * width;
+    const uint32_t* tb = sources[b].data + sources[b].position * width;
+    return std::lexicographical_compare(tb, tb + width, ta, ta + width);
+}
+
+
+const uint32_t* ExternalSorter::Cursor::tuple() const {
+    const Source& source = sources[heap.front()];
+    return source.data + source.position * width;
+}
+
+
+void ExternalSorter::Cursor::next() {
+    auto order = [this](size_t a, size_t b) { return greater(a, b); };
+    std::pop_heap(heap.begin(), heap.end(), order);
+    Source& source = sources[heap.back()];
+    if (++source.position < source.count || (source.file && loadChunk(source))) {
+        std::push_heap(heap.begin(), heap.end(), order);
+    } else {
+        heap.pop_back();
+    }
+}
@@ -0,0 +1,537 @@
+/**
+ * @file incremental_miner.cpp
+ * @brief Implementation of the incremental colocation mining engine
+ */
+
+#include "incremental_miner.h"
+#include "miner.h"
+#include "utils.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <set>
+#include <unordered_set>
+#include <omp.h>
+
+namespace {
+
+// Order of neighbor lists: by feature code, then by slot (which is also the
+// feature index order, since both only grow and compaction keeps their order)
+struct SlotOrder {
+    const std::vector<FeatureCode>& feature;
+
+    bool operator()(uint32_t a, uint32_t b) const {
+        return feature[a] != feature[b] ? feature[a] < feature[b] : a < b;
+    }
+};
+
+// Position of a feature in a pattern, or -1
+int slotOfFeature(const Pattern& pattern, FeatureCode feature) {
+    for (size_t slot = 0; slot < pattern.size(); ++slot) {
+        if (pattern[slot] == feature) return static_cast<int>(slot);
+    }
+    return -1;
+}
+
+} // namespace
+
+
+IncrementalMiner::IncrementalMiner(double distThresh, double minPrevalence)
+    : distanceThreshold(distThresh), minPrev(minPrevalence) {}
+
+
+// ============================================================================
+// Instance storage and neighbor lists
+// ============================================================================
+
+uint64_t IncrementalMiner::cellKey(int64_t cx, int64_t cy) {
+    return (static_cast<uint64_t>(static_cast<uint32_t>(cx)) << 32) | static_cast<uint32_t>(cy);
+}
+
+
+uint64_t IncrementalMiner::cellOf(double x, double y) const {
+    return cellKey(static_cast<int64_t>(std::floor(x / distanceThreshold)),
+                   static_cast<int64_t>(std::floor(y / distanceThreshold)));
+}
+
+
+bool IncrementalMiner::areNeighbors(uint32_t a, uint32_t b) const {
+    const std::vector<uint32_t>& list = adjacency[a];
+    return std::binary_search(list.begin(), list.end(), b, SlotOrder{slotFeature});
+}
+
+
+uint32_t IncrementalMiner::insertInstance(SpatialInstance instance) {
+    uint32_t slot = static_cast<uint32_t>(instances.size());
+    FeatureCode feature = instance.feature;
+    instance.featureIndex = static_cast<uint32_t>(featureSlots[feature].size());
+
+    instances.push_back(std::move(instance));
+    alive.push_back(1);
+    slotFeature.push_back(feature);
+    adjacency.emplace_back();
+    featureSlots[feature].push_back(slot);
+    featureSizes[feature]++;
+
+    const SpatialInstance& inst = instances.back();
+    slotById[inst.id] = slot;
+
+    // Neighbors can only lie in the instance's cell or the 8 cells around it
+    std::vector<uint32_t>& own = adjacency[slot];
+    int64_t cx = static_cast<int64_t>(std::floor(inst.x / distanceThreshold));
+    int64_t cy = static_cast<int64_t>(std::floor(inst.y / distanceThreshold));
+    for (int64_t dx = -1; dx <= 1; ++dx) {
+        for (int64_t dy = -1; dy <= 1; ++dy) {
+            auto it = cells.find(cellKey(cx + dx, cy + dy));
+            if (it == cells.end()) continue;
+            for (uint32_t other : it->second) {
+                if (slotFeature[other] == feature) continue;
+                double ox = instances[other].x - inst.x;
+                double oy = instances[other].y - inst.y;
+                if (std::sqrt(ox * ox + oy * oy) <= distanceThreshold) {
+                    own.push_back(other);
+                }
+            }
+        }
+    }
+
+    SlotOrder order{slotFeature};
+    std::sort(own.begin(), own.end(), order);
+    for (uint32_t other : own) {
+        std::vector<uint32_t>& list = adjacency[other];
+        list.insert(std::lower_bound(list.begin(), list.end(), slot, order), slot);
+    }
+
+    cells[cellOf(inst.x, inst.y)].push_back(slot);
+    return slot;
+}
+
+
+void IncrementalMiner::eraseInstance(uint32_t slot) {
+    SlotOrder order{slotFeature};
+    for (uint32_t other : adjacency[slot]) {
+        std::vector<uint32_t>& list = adjacency[other];
+        auto it = std::lower_bound(list.begin(), list.end(), slot, order);
+        if (it != list.end() && *it == slot) {
+            list.erase(it);
+        }
+    }
+    std::vector<uint32_t>().swap(adjacency[slot]);
+
+    const SpatialInstance& inst = instances[slot];
+    auto cell = cells.find(cellOf(inst.x, inst.y));
+    if (cell != cells.end()) {
+        std::vector<uint32_t>& members = cell->second;
+        members.erase(std::find(members.begin(), members.end(), slot));
+        if (members.empty()) {
+            cells.erase(cell);
+        }
+    }
+
+    alive[slot] = 0;
+    featureSizes[slotFeature[slot]]--;
+    slotById.erase(inst.id);
+}
+
+
+void IncrementalMiner::compact() {
+    const uint32_t kDropped = std::numeric_limits<uint32_t>::max();
+
+    // New slot of every live slot, and new feature index of every live index
+    std::vector<uint32_t> slotMap(instances.size(), kDropped);
+    uint32_t live = 0;
+    for (uint32_t slot = 0; slot < instances.size(); ++slot) {
+        if (alive[slot]) slotMap[slot] = live++;
+    }
+    std::vector<std::vector<uint32_t>> indexMap(featureTypes.size());
+    std::vector<std::vector<uint32_t>> slotsByFeature(featureTypes.size());
+    for (size_t f = 0; f < featureTypes.size(); ++f) {
+        indexMap[f].assign(featureSlots[f].size(), kDropped);
+        slotsByFeature[f].reserve(featureSizes[f]);
+        for (uint32_t index = 0; index < featureSlots[f].size(); ++index) {
+            uint32_t slot = featureSlots[f][index];
+            if (alive[slot]) {
+                indexMap[f][index] = static_cast<uint32_t>(slotsByFeature[f].size());
+                slotsByFeature[f].push_back(slotMap[slot]);
+            }
+        }
+    }
+
+    // Instances and per-slot state, keeping only the live slots
+    std::deque<SpatialInstance> liveInstances;
+    std::vector<FeatureCode> liveFeatures;
+    std::vector<std::vector<uint32_t>> liveAdjacency;
+    liveFeatures.reserve(live);
+    liveAdjacency.reserve(live);
+    for (uint32_t slot = 0; slot < instances.size(); ++slot) {
+        if (!alive[slot]) continue;
+        SpatialInstance& inst = instances[slot];
+        inst.featureIndex = indexMap[inst.feature][inst.featureIndex];
+        liveInstances.push_back(std::move(inst));
+        liveFeatures.push_back(slotFeature[slot]);
+
+        // Neighbor lists only hold live slots
+        std::vector<uint32_t>& list = adjacency[slot];
+        for (uint32_t& other : list) other = slotMap[other];
+        liveAdjacency.push_back(std::move(list));
+    }
+    instances = std::move(liveInstances);
+    slotFeature = std::move(liveFeatures);
+    adjacency = std::move(liveAdjacency);
+    alive.assign(live, 1);
+    featureSlots = std::move(slotsByFeature);
+
+    for (auto& entry : slotById) entry.second = slotMap[entry.second];
+    for (auto& cell : cells) {
+        for (uint32_t& slot : cell.second) slot = slotMap[slot];
+    }
+
+    // Bitmaps are indexed by feature index; deleted instances were unset already
+    for (auto& entry : tracked) {
+        const Pattern& pattern = entry.first;
+        for (size_t slot = 0; slot < pattern.size(); ++slot) {
+            const std::vector<uint32_t>& map = indexMap[pattern[slot]];
+            ParticipationBitmap& old = entry.second[slot];
+            ParticipationBitmap remapped;
+            remapped.reset(featureSlots[pattern[slot]].size());
+            for (uint32_t index = 0; index < map.size(); ++index) {
+                if (map[index] != kDropped && index < old.words.size() * 64 && old.test(index)) {
+                    remapped.set(map[index]);
+                }
+            }
+            old = std::move(remapped);
+        }
+    }
+}
+
+
+// ============================================================================
+// Participation
+// ============================================================================
+
+bool IncrementalMiner::extendClique(uint32_t member, const Pattern& rest, size_t depth, uint32_t* chosen) const {
+    if (depth == rest.size()) {
+        return true;
+    }
+
+    // Candidates are the member's neighbors of the next feature...
+    const std::vector<uint32_t>& list = adjacency[member];
+    FeatureCode feature = rest[depth];
+    auto begin = std::lower_bound(list.begin(), list.end(), feature,
+        [this](uint32_t s, FeatureCode f) { return slotFeature[s] < f; });
+
+    for (auto it = begin; it != list.end() && slotFeature[*it] == feature; ++it) {
+        // ...that are neighbors of every member chosen so far
+        bool clique = true;
+        for (size_t i = 0; i < depth && clique; ++i) {
+            clique = areNeighbors(chosen[i], *it);
+        }
+        if (!clique) continue;
+
+        chosen[depth] = *it;
+        if (extendClique(member, rest, depth + 1, chosen)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+
+bool IncrementalMiner::findClique(uint32_t member, const Pattern& pattern, uint32_t* clique) const {
+    Pattern rest;
+    for (FeatureCode feature : pattern) {
+        if (feature != slotFeature[member]) {
+            rest.push_back(feature);
+        }
+    }
+
+    uint32_t chosen[kMaxPatternSize];
+    if (!extendClique(member, rest, 0, chosen)) {
+        return false;
+    }
+
+    for (size_t slot = 0, r = 0; slot < pattern.size(); ++slot) {
+        clique[slot] = pattern[slot] == slotFeature[member] ? member : chosen[r++];
+    }
+    return true;
+}
+
+
+std::vector<ParticipationBitmap> IncrementalMiner::evaluatePattern(const Pattern& pattern) const {
+    size_t k = pattern.size();
+    std::vector<ParticipationBitmap> slots(k);
+    for (size_t slot = 0; slot < k; ++slot) {
+        slots[slot].reset(featureSlots[pattern[slot]].size());
+    }
+
+    // Every clique found marks all of its members, so only instances not
+    // marked yet need a search of their own
+    uint32_t clique[kMaxPatternSize];
+    for (size_t slot = 0; slot < k; ++slot) {
+        const std::vector<uint32_t>& members = featureSlots[pattern[slot]];
+        for (uint32_t index = 0; index < members.size(); ++index) {
+            if (!alive[members[index]] || slots[slot].test(index)) continue;
+            if (findClique(members[index], pattern, clique)) {
+                for (size_t t = 0; t < k; ++t) {
+                    slots[t].set(instances[clique[t]].featureIndex);
+                }
+            }
+        }
+    }
+    return slots;
+}
+
+
+void IncrementalMiner::updatePattern(const Pattern& pattern, std::vector<ParticipationBitmap>& slots,
+                                     const std::vector<uint32_t>& affected) const {
+    size_t k = pattern.size();
+    for (size_t slot = 0; slot < k; ++slot) {
+        slots[slot].grow(featureSlots[pattern[slot]].size());
+    }
+
+    // Forget the affected instances first: a bit set while re-searching them
+    // always comes from a clique that exists now
+    for (uint32_t member : affected) {
+        int slot = slotOfFeature(pattern, slotFeature[member]);
+        if (slot >= 0) {
+            slots[slot].unset(instances[member].featureIndex);
+        }
+    }
+
+    uint32_t clique[kMaxPatternSize];
+    for (uint32_t member : affected) {
+        int slot = slotOfFeature(pattern, slotFeature[member]);
+        if (slot < 0 || !alive[member] || slots[slot].test(instances[member].featureIndex)) continue;
+        if (findClique(member, pattern, clique)) {
+            for (size_t t = 0; t < k; ++t) {
+                slots[t].set(instances[clique[t]].featureIndex);
+            }
+        }
+    }
+}
+
+
+bool IncrementalMiner::isPrevalent(const Pattern& pattern, const std::vector<ParticipationBitmap>& slots) const {
+    for (size_t slot = 0; slot < pattern.size(); ++slot) {
+        size_t size = featureSizes[pattern[slot]];
+        if (size == 0 || slots[slot].count < JoinlessMiner::participationThreshold(minPrev, size)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+
+// ============================================================================
+// Mining
+// ============================================================================
+
+void IncrementalMiner::refresh() {
+    std::unordered_map<Pattern, std::vector<ParticipationBitmap>, PatternHash> next;
+    std::vector<Pattern> found;
+
+    // Size-2 candidates: every pair of features that still has instances
+    std::vector<Pattern> candidates;
+    for (FeatureCode a = 0; a < featureTypes.size(); ++a) {
+        for (FeatureCode b = a + 1; b < featureTypes.size(); ++b) {
+            if (featureSizes[a] > 0 && featureSizes[b] > 0) {
+                Pattern pair;
+                pair.push_back(a);
+                pair.push_back(b);
+                candidates.push_back(pair);
+            }
+        }
+    }
+
+    while (!candidates.empty()) {
+        std::vector<std::vector<ParticipationBitmap>> bitmaps(candidates.size());
+        std::vector<char> known(candidates.size(), 0);
+        for (size_t i = 0; i < candidates.size(); ++i) {
+            auto it = tracked.find(candidates[i]);
+            if (it != tracked.end()) {
+                bitmaps[i] = std::move(it->second);
+                known[i] = 1;
+            }
+        }
+
+        // Only candidates the previous pass did not track are evaluated in full
+        #pragma omp parallel for schedule(dynamic)
+        for (int64_t i = 0; i < static_cast<int64_t>(candidates.size()); ++i) {
+            if (!known[i]) {
+                bitmaps[i] = evaluatePattern(candidates[i]);
+            }
+        }
+
+        std::vector<Pattern> levelPrevalent;
+        for (size_t i = 0; i < candidates.size(); ++i) {
+            if (isPrevalent(candidates[i], bitmaps[i])) {
+                levelPrevalent.push_back(candidates[i]);
+            }
+            next.emplace(candidates[i], std::move(bitmaps[i]));
+        }
+
+        found.insert(found.end(), levelPrevalent.begin(), levelPrevalent.end());
+        candidates = JoinlessMiner::generateCandidatePatterns(levelPrevalent);
+    }
+
+    tracked = std::move(next);
+    prevalent = std::move(found);
+}
+
+
+void IncrementalMiner::build(const std::vector<SpatialInstance>& dataset) {
+    instances.clear();
+    alive.clear();
+    slotFeature.clear();
+    adjacency.clear();
+    slotById.clear();
+    cells.clear();
+    tracked.clear();
+    prevalent.clear();
+
+    std::vector<SpatialInstance> coded(dataset);
+    featureTypes = assignFeatureCodes(coded);
+    featureSlots.assign(featureTypes.size(), {});
+    featureSizes.assign(featureTypes.size(), 0);
+
+    for (auto& instance : coded) {
+        insertInstance(std::move(instance));
+    }
+    refresh();
+}
+
+
+MiningDelta IncrementalMiner::applyBatch(const std::vector<SpatialInstance>& inserted,
+                                         const std::vector<instanceID>& deleted) {
+    if (inserted.empty() && deleted.empty()) {
+        return MiningDelta();
+    }
+
+    std::vector<Colocation> before = prevalentPatterns();
+
+    bool newFeature = false;
+    for (const auto& instance : inserted) {
+        if (!std::binary_search(featureTypes.begin(), featureTypes.end(), instance.type)) {
+            newFeature = true;
+            break;
+        }
+    }
+
+    if (newFeature) {
+        // Feature codes follow the sorted feature names, so they all may shift
+        std::unordered_set<instanceID> replaced(deleted.begin(), deleted.end());
+        for (const auto& instance : inserted) {
+            replaced.insert(instance.id);
+        }
+        std::vector<SpatialInstance> dataset;
+        for (uint32_t slot = 0; slot < instances.size(); ++slot) {
+            if (alive[slot] && replaced.find(instances[slot].id) == replaced.end()) {
+                dataset.push_back(instances[slot]);
+            }
+        }
+        // The last insertion of an ID wins, as in the incremental path
+        std::unordered_map<instanceID, size_t> lastInsert;
+        for (size_t i = 0; i < inserted.size(); ++i) {
+            lastInsert[inserted[i].id] = i;
+        }
+        for (size_t i = 0; i < inserted.size(); ++i) {
+            if (lastInsert[inserted[i].id] == i) {
+                dataset.push_back(inserted[i]);
+            }
+        }
+        build(dataset);
+    } else {
+        // Instances whose participation may change: the changed ones and their
+        // neighbors (before a deletion, after an insertion)
+        std::vector<uint32_t> affected;
+        std::vector<char> changedFeature(featureTypes.size(), 0);
+        auto remove = [&](uint32_t slot) {
+            affected.push_back(slot);
+            affected.insert(affected.end(), adjacency[slot].begin(), adjacency[slot].end());
+            changedFeature[slotFeature[slot]] = 1;
+            eraseInstance(slot);
+        };
+
+        for (const auto& id : deleted) {
+            auto it = slotById.find(id);
+            if (it != slotById.end()) {
+                remove(it->second);
+            }
+        }
+        for (const auto& instance : inserted) {
+            auto it = slotById.find(instance.id);
+            if (it != slotById.end()) {
+                remove(it->second);
+            }
+            SpatialInstance coded = instance;
+            coded.feature = static_cast<FeatureCode>(
+                std::lower_bound(featureTypes.begin(), featureTypes.end(), instance.type) - featureTypes.begin());
+            uint32_t slot = insertInstance(std::move(coded));
+            affected.push_back(slot);
+            affected.insert(affected.end(), adjacency[slot].begin(), adjacency[slot].end());
+            changedFeature[slotFeature[slot]] = 1;
+        }
+        std::sort(affected.begin(), affected.end());
+        affected.erase(std::unique(affected.begin(), affected.end()), affected.end());
+
+        // Only patterns containing a changed feature can gain or lose a clique
+        std::vector<std::pair<const Pattern*, std::vector<ParticipationBitmap>*>> touched;
+        for (auto& entry : tracked) {
+            for (FeatureCode feature : entry.first) {
+                if (changedFeature[feature]) {
+                    touched.emplace_back(&entry.first, &entry.second);
+                    break;
+                }
+            }
+        }
+
+        #pragma omp parallel for schedule(dynamic)
+        for (int64_t i = 0; i < static_cast<int64_t>(touched.size()); ++i) {
+            updatePattern(*touched[i].first, *touched[i].second, affected);
+        }
+
+        // Compaction costs in proportion to the slots, so amortized over the
+        // deletions that made the tombstones it is constant per deletion
+        if (instances.size() - slotById.size() > slotById.size()) {
+            compact();
+        }
+        refresh();
+    }
+
+    std::vector<Colocation> after = prevalentPatterns();
+    std::set<Colocation> beforeSet(before.begin(), before.end());
+    std::set<Colocation> afterSet(after.begin(), after.end());
+
+    MiningDelta delta;
+    for (const auto& pattern : after) {
+        if (beforeSet.find(pattern) == beforeSet.end()) {
+            delta.gained.push_back(pattern);
+        }
+    }
+    for (const auto& pattern : before) {
+        if (afterSet.find(pattern) == afterSet.end()) {
+            delta.lost.push_back(pattern);
+        }
+    }
+    return delta;
+}
+
+
+std::vector<Colocation> IncrementalMiner::decodePatterns(const std::vector<Pattern>& patterns) const {
+    std::vector<Colocation> decoded;
+    decoded.reserve(patterns.size());
+    for (const auto& pattern : patterns) {
+        Colocation colocation;
+        colocation.reserve(pattern.size());
+        for (FeatureCode code : pattern) {
+            colocation.push_back(featureTypes[code]);
+        }
+        decoded.push_back(std::move(colocation));
+    }
+    return decoded;
+}
+
+
+std::vector<Colocation> IncrementalMiner::prevalentPatterns() const {
+    return decodePatterns(prevalent);
+}
@@ -0,0 +1,233 @@
+/**
+ * @file joinless_capi.cpp
+ * @brief C interface over ColocationSession
+ */
+
+#include "joinless.h"
+#include "colocation_session.h"
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct joinless_session {
+    ColocationSession session;
+    std::unordered_map<std::string, int32_t> callerCodes;  ///< Feature name -> index in the loaded feature_names
+};
+
+struct joinless_result {
+    std::vector<Colocation> patterns;
+    std::vector<double> participation;  ///< Per pattern, empty unless requested
+    std::vector<int64_t> offsets;       ///< Pattern boundaries in `codes`
+    std::vector<int32_t> codes;         ///< Caller feature codes of every pattern, pattern after pattern
+};
+
+namespace {
+
+thread_local std::string lastError;
+
+int fail(int code, const std::string& message) {
+    lastError = message;
+    return code;
+}
+
+// Run a call, turning exceptions into status codes and the thread's last error
+template <typename Body>
+int guarded(Body body) {
+    try {
+        body();
+        return JOINLESS_OK;
+    } catch (const std::invalid_argument& e) {
+        return fail(JOINLESS_INVALID_ARGUMENT, e.what());
+    } catch (const std::logic_error& e) {
+        return fail(JOINLESS_INVALID_STATE, e.what());
+    } catch (const std::bad_alloc&) {
+        return fail(JOINLESS_FAILED, "Out of memory");
+    } catch (const std::exception& e) {
+        return fail(JOINLESS_FAILED, e.what());
+    } catch (...) {
+        return fail(JOINLESS_FAILED, "Unknown error");
+    }
+}
+
+// Options fields the caller's struct actually contains
+bool hasField(const joinless_options* options, size_t fieldEnd) {
+    return options->struct_size >= fieldEnd;
+}
+
+} // namespace
+
+
+extern "C" {
+
+int joinless_api_version(void) {
+    return JOINLESS_API_VERSION;
+}
+
+const char* joinless_last_error(void) {
+    return lastError.c_str();
+}
+
+void joinless_options_init(joinless_options* options) {
+    if (options == nullptr) return;
+    options->struct_size = sizeof(joinless_options);
+    options->min_prevalence = 0.6;
+    options->strategy = JOINLESS_LEVELWISE;
+    options->memory_budget = 0;
+    options->spill_dir = nullptr;
+    options->participation = 0;
+}
+
+joinless_session* joinless_session_create(void) {
+    joinless_session* session = nullptr;
+    guarded([&] { session = new joinless_session(); });
+    return session;
+}
+
+void joinless_session_free(joinless_session* session) {
+    delete session;
+}
+
+int joinless_session_load(joinless_session* session,
+                          const int32_t* feature_codes, const double* x, const double* y,
+                          const int64_t* instance_numbers, size_t count,
+                          const char* const* feature_names, size_t num_features,
+                          int order) {
+    if (session == nullptr || (count > 0 && (feature_codes == nullptr || x == nullptr || y == nullptr)) ||
+        (num_features > 0 && feature_names == nullptr)) {
+        return fail(JOINLESS_INVALID_ARGUMENT, "joinless_session_load: null argument");
+    }
+    if (order < JOINLESS_ORDER_NONE || order > JOINLESS_ORDER_HILBERT) {
+        return fail(JOINLESS_INVALID_ARGUMENT, "joinless_session_load: unknown order");
+    }
+    return guarded([&] {
+        std::vector<std::string> names;
+        names.reserve(num_features);
+        for (size_t f = 0; f < num_features; ++f) {
+            if (feature_names[f] == nullptr) throw std::invalid_argument("Feature name is null");
+            names.emplace_back(feature_names[f]);
+        }
+        SpatialOrder spatialOrder = (order == JOINLESS_ORDER_MORTON) ? SpatialOrder::Morton
+                                  : (order == JOINLESS_ORDER_HILBERT) ? SpatialOrder::Hilbert
+                                  : SpatialOrder::None;
+        session->session.loadInstances(feature_codes, x, y, instance_numbers, count, names, spatialOrder);
+
+        session->callerCodes.clear();
+        for (size_t f = 0; f < names.size(); ++f) {
+            session->callerCodes.emplace(names[f], static_cast<int32_t>(f));
+        }
+    });
+}
+
+size_t joinless_session_size(const joinless_session* session) {
+    return session == nullptr ? 0 : session->session.getInstances().size();
+}
+
+int joinless_session_build_graph(joinless_session* session, double distance) {
+    if (session == nullptr) {
+        return fail(JOINLESS_INVALID_ARGUMENT, "joinless_session_build_graph: null session");
+    }
+    return guarded([&] { session->session.buildNeighborGraph(distance); });
+}
+
+int joinless_session_mine(const joinless_session* session, const joinless_options* options,
+                          joinless_result** result) {
+    if (session == nullptr || result == nullptr) {
+        return fail(JOINLESS_INVALID_ARGUMENT, "joinless_session_mine: null argument");
+    }
+    *result = nullptr;
+
+    joinless_options defaults;
+    joinless_options_init(&defaults);
+    if (options == nullptr) options = &defaults;
+
+    MiningOptions mining;
+    if (hasField(options, offsetof(joinless_options, min_prevalence) + sizeof(double))) {
+        mining.minPrevalence = options->min_prevalence;
+    }
+    if (hasField(options, offsetof(joinless_options, strategy) + sizeof(int))) {
+        if (options->strategy == JOINLESS_DEPTHFIRST) mining.strategy = "depthfirst";
+        else if (options->strategy != JOINLESS_LEVELWISE) {
+            return fail(JOINLESS_INVALID_ARGUMENT, "joinless_session_mine: unknown strategy");
+        }
+    }
+    if (hasField(options, offsetof(joinless_options, memory_budget) + sizeof(size_t))) {
+        mining.memoryBudget = options->memory_budget;
+    }
+    if (hasField(options, offsetof(joinless_options, spill_dir) + sizeof(const char*)) &&
+        options->spill_dir != nullptr) {
+        mining.spillDir = options->spill_dir;
+    }
+    bool participation = hasField(options, offsetof(joinless_options, participation) + sizeof(int)) &&
+                         options->participation != 0;
+
+    return guarded([&] {
+        auto mined = std::make_unique<joinless_result>();
+        mined->patterns = session->session.mine(mining);
+        if (participation) {
+            mined->participation = session->session.participationIndices(mined->patterns);
+        }
+
+        mined->offsets.push_back(0);
+        for (const auto& pattern : mined->patterns) {
+            for (const auto& feature : pattern) {
+                auto it = session->callerCodes.find(feature);
+                mined->codes.push_back(it == session->callerCodes.end() ? -1 : it->second);
+            }
+            mined->offsets.push_back(static_cast<int64_t>(mined->codes.size()));
+        }
+        *result = mined.release();
+    });
+}
+
+size_t joinless_result_count(const joinless_result* result) {
+    return result == nullptr ? 0 : result->patterns.size();
+}
+
+size_t joinless_result_pattern_size(const joinless_result* result, size_t index) {
+    if (result == nullptr || index >= result->patterns.size()) return 0;
+    return result->patterns[index].size();
+}
+
+const char* joinless_result_feature(const joinless_result* result, size_t index, size_t slot) {
+    if (result == nullptr || index >= result->patterns.size()) return nullptr;
+    const Colocation& pattern = result->patterns[index];
+    return slot < pattern.size() ? pattern[slot].c_str() : nullptr;
+}
+
+double joinless_result_participation(const joinless_result* result, size_t index) {
+    if (result == nullptr || index >= result->participation.size()) {
+        return std::numeric_limits<double>::quiet_NaN();
+    }
+    return result->participation[index];
+}
+
+size_t joinless_result_total_features(const joinless_result* result) {
+    return result == nullptr ? 0 : result->codes.size();
+}
+
+int joinless_result_export(const joinless_result* result, int64_t* offsets, int32_t* codes,
+                           double* participation) {
+    if (result == nullptr || offsets == nullptr || (codes == nullptr && !result->codes.empty())) {
+        return fail(JOINLESS_INVALID_ARGUMENT, "joinless_result_export: null argument");
+    }
+    std::copy(result->offsets.begin(), result->offsets.end(), offsets);
+    std::copy(result->codes.begin(), result->codes.end(), codes);
+    if (participation != nullptr) {
+        for (size_t i = 0; i < result->patterns.size(); ++i) {
+            participation[i] = joinless_result_participation(result, i);
+        }
+    }
+    return JOINLESS_OK;
+}
+
+void joinless_result_free(joinless_result* result) {
+    delete result;
+}
+
+} // extern "C"
@@ -8,52 +8,227 @@
 #include "spatial_index.h"
 #include "neighborhood_mgr.h"
 #include "miner.h"
+#include "partitioned_miner.h"
+#include "sliding_window_miner.h"
+#include "checkpoint_store.h"
+#include "region.h"
+#include "region_view.h"
+#include "mining_server.h"
 #include "utils.h"
 #include <iostream>
 #include <fstream>
 #include <chrono>
 #include <iomanip>
-
- //Show memmory usage
-#include <windows.h>
-#include <psapi.h>
-#include <stdio.h>
-#pragma comment(lib, "psapi.lib")
+#include <sstream>
+#include <memory>
+#include <algorithm>
+#include <cstdlib>
 
 int main(int argc, char* argv[]) {
+    // Worker mode of partitioned mining, checked before anything else runs
+    if (argc == 4 && std::string(argv[1]) == PartitionedMiner::kWorkerFlag) {
+        return PartitionedMiner::runWorker(std::atoi(argv[2]), std::atoi(argv[3]));
+    }
+
     auto programStart = std::chrono::high_resolution_clock::now();
 
     // ========================================================================
     // Step 1: Load Configuration
     // ========================================================================
-    std::string config_path = (argc > 1) ? argv[1] : "src/c++/config.txt";
-    AppConfig config = ConfigLoader::load(config_path);
+    // Arguments: [config path] [--resume]
+    std::string config_path = "src/c++/config.txt";
+    bool resume = false;
+    for (int a = 1; a < argc; ++a) {
+        std::string arg = argv[a];
+        if (arg == "--resume") resume = true;
+        else config_path = arg;
+    }
+    AppConfig config;
+    try {
+        config = ConfigLoader::load(config_path);
+    } catch (const std::exception& e) {
+        std::cerr << "Error: invalid config " << config_path << ": " << e.what() << "\n";
+        return 1;
+    }
+    if (resume && config.checkpointDir.empty()) {
+        std::cerr << "Warning: --resume needs checkpoint_dir in the config; mining from the start.\n";
+    }
+    if (!config.region.empty() && (config.streamWindow > 0.0 || config.miningStrategy == "partitioned")) {
+        std::cerr << "Warning: region applies to levelwise and depthfirst mining only; mining all instances.\n";
+    }
 
-    // ========================================================================
-    // Step 2: Load Data
-    // ========================================================================
-    auto instances = DataLoader::load_csv(config.datasetPath, config.percentageData);
+    if (!config.serverSocket.empty()) {
+        // Server mode: answer mining requests until the process is stopped
+        MiningServer server(config);
+        try {
+            server.run();
+        } catch (const std::exception& e) {
+            std::cerr << "Error: server stopped: " << e.what() << "\n";
+            return 1;
+        }
+        return 0;
+    }
 
-    // ========================================================================
-    // Step 3: Build Spatial Index
-    // ========================================================================
-    // Pass distance parameter d from config to spatial index
-    SpatialIndex spatial_idx(config.neighborDistance);
-    auto neighborPairs = spatial_idx.findNeighborPair(instances);
+    std::vector<Colocation> colocations;
+    size_t totalInstances = 0;
+    uint32_t resumedLevel = 0;  // Level a checkpointed run continued after (0 = none)
+    bool regionMined = false;    // True if only the instances of config.region were mined
+    size_t regionInstances = 0;  // Instances inside the mined region
+    std::vector<std::string> windowLog;  // Prevalence changes per window update (streaming only)
 
-    // ========================================================================
-    // Step 4: Materialize Neighborhoods
-    // ========================================================================
-    NeighborhoodMgr neighbor_mgr;
-    neighbor_mgr.buildFromPairs(neighborPairs);
+    auto formatPattern = [](const Colocation& col) {
+        std::string text = "{";
+        for (size_t i = 0; i < col.size(); ++i) {
+            text += (i > 0 ? ", " : "") + col[i];
+        }
+        return text + "}";
+    };
 
-    // ========================================================================
-    // Step 5: Mine Colocation Patterns
-    // ========================================================================
-    JoinlessMiner miner;
+    if (config.streamWindow > 0.0) {
+        // ====================================================================
+        // Streaming: slide a time window over timestamped events
+        // ====================================================================
+        auto events = DataLoader::load_events(config.datasetPath);
+        totalInstances = events.size();
+
+        // Each update only touches the events entering and leaving the window
+        SlidingWindowMiner stream(config.neighborDistance, config.minPrev, config.streamWindow);
+        size_t next = 0;
+        double t = events.empty() ? 0.0 : events.front().timestamp;
+        while (next < events.size()) {
+            std::vector<SpatialEvent> arrivals;
+            while (next < events.size() && events[next].timestamp <= t) {
+                arrivals.push_back(events[next++]);
+            }
+
+            MiningDelta delta = stream.advance(arrivals, t);
+            if (!delta.gained.empty() || !delta.lost.empty()) {
+                std::ostringstream line;
+                line << "t=" << t << " (" << stream.size() << " instances)";
+                for (const auto& col : delta.gained) line << " +" << formatPattern(col);
+                for (const auto& col : delta.lost) line << " -" << formatPattern(col);
+                windowLog.push_back(line.str());
+            }
+            t += config.streamStep;
+        }
+        colocations = stream.prevalentPatterns();
+    } else {
+        // ====================================================================
+        // Step 2: Load Data
+        // ====================================================================
+        auto instances = DataLoader::load_csv(config.datasetPath, config.percentageData,
+                                              parseSpatialOrder(config.spatialOrder));
+
+        if (config.miningStrategy == "partitioned") {
+            // ================================================================
+            // Steps 3-5: Neighbor search, stars and participants per tile,
+            // in worker processes; only participation bitmaps are merged here
+            // ================================================================
+            PartitionedMiner partitioned(config.neighborDistance, config.partitionTiles,
+                                         config.partitionWorkers);
+#ifdef __linux__
+            partitioned.setWorkerExecutable("/proc/self/exe");
+#else
+            partitioned.setWorkerExecutable(argv[0]);
+#endif
+            try {
+                colocations = partitioned.mineColocations(config.minPrev, instances);
+            } catch (const std::exception& e) {
+                std::cerr << "Error: partitioned mining failed: " << e.what() << "\n";
+                return 1;
+            }
+        } else {
+            // ================================================================
+            // Step 3: Build Spatial Index
+            // ================================================================
+            // Pass distance parameter d from config to spatial index
+            SpatialIndex spatial_idx(config.neighborDistance);
+
+            // ================================================================
+            // Step 4: Materialize Neighborhoods
+            // ================================================================
+            // Neighbor search and star construction run as one fused pass; with
+            // checkpoints, the neighbor lists are cached and reused by later runs
+            NeighborhoodMgr neighbor_mgr;
+            std::unique_ptr<CheckpointStore> checkpoints;
+            uint64_t graphKey = 0;
+            bool indexBuilt = true;
+            if (!config.checkpointDir.empty()) {
+                checkpoints = std::make_unique<CheckpointStore>(config.checkpointDir);
+                graphKey = CheckpointStore::fingerprint(instances, config.neighborDistance);
+
+                std::vector<size_t> offsets;
+                std::vector<uint32_t> neighbors;
+                if (checkpoints->loadNeighborGraph(graphKey, instances.size(), offsets, neighbors)) {
+                    indexBuilt = false;
+                } else {
+                    spatial_idx.findStarNeighbors(instances, offsets, neighbors);
+                    checkpoints->saveNeighborGraph(graphKey, offsets, neighbors);
+                }
+                neighbor_mgr.buildFromStarLists(instances, offsets, std::move(neighbors));
+            } else {
+                neighbor_mgr.buildFromIndex(instances, spatial_idx);
+            }
+
+            // A region is cut from the whole dataset's index and stars; only its
+            // instances are mined, with prevalence over the in-region ones
+            const std::vector<SpatialInstance>* mined = &instances;
+            NeighborhoodMgr* stars = &neighbor_mgr;
+            std::unique_ptr<RegionView> region;
+            if (!config.region.empty()) {
+                if (!indexBuilt) {
+                    spatial_idx.build(instances);
+                }
+                region = std::make_unique<RegionView>(Region::parse(config.region), instances,
+                                                      config.neighborDistance, spatial_idx, neighbor_mgr);
+                mined = &region->getInstances();
+                stars = &region->getNeighborhoods();
+            }
+
+            // ================================================================
+            // Step 5: Mine Colocation Patterns
+            // ================================================================
+            JoinlessMiner miner;
+            miner.setMemoryBudget(static_cast<size_t>(config.maxMemoryMb * 1024 * 1024), config.spillDir);
+            miner.setFeatureConstraints(config.includeFeatures, config.excludeFeatures);
+            std::string conflict = miner.constraintConflict(*mined);
+            if (!conflict.empty()) {
+                std::cerr << "Warning: " << conflict << "; no pattern can satisfy the feature constraints.\n";
+            }
+            if (region) {
+                miner.setCoreSizes(region->getCoreSizes());
+            }
+            if (checkpoints) {
+                // Constrained runs mine a different lattice, so they get their own key
+                uint64_t runKey = CheckpointStore::fingerprint(graphKey, config.minPrev);
+                if (!config.includeFeatures.empty() || !config.excludeFeatures.empty()) {
+                    Colocation include = config.includeFeatures;
+                    Colocation exclude = config.excludeFeatures;
+                    std::sort(include.begin(), include.end());
+                    std::sort(exclude.begin(), exclude.end());
+                    std::string constraints = formatPattern(include) + formatPattern(exclude);
+                    runKey = CheckpointStore::fingerprint(runKey, constraints);
+                }
+                if (region) {
+                    runKey = CheckpointStore::fingerprint(runKey, "region=" + config.region);
+                }
+                miner.enableCheckpoints(checkpoints.get(), runKey, resume);
+            }
  
-    auto colocations = miner.mineColocations(config.minPrev, &neighbor_mgr, instances);
-    
+            // Depth-first mining bounds memory by one prefix class instead of one level
+            colocations = (config.miningStrategy == "depthfirst")
+                ? miner.mineColocationsDepthFirst(config.minPrev, stars, *mined)
+                : miner.mineColocations(config.minPrev, stars, *mined);
+            resumedLevel = miner.resumedLevel();
+            if (region) {
+                regionMined = true;
+                regionInstances = region->coreSize();
+            }
+        }
+
+        totalInstances = instances.size();
+    }
+
     // ========================================================================
     // Final Report
     // ========================================================================
@@ -62,13 +237,7 @@ int main(int argc, char* argv[]) {
 
     // --- REPORT GENERATION (FILE ONLY) ---
     // 1. Get Memory Info (Peak)
-    HANDLE handle = GetCurrentProcess();
-    PROCESS_MEMORY_COUNTERS memCounter;
-    SIZE_T peakMemMB = 0;
-
-    if (GetProcessMemoryInfo(handle, &memCounter, sizeof(memCounter))) {
-        peakMemMB = memCounter.PeakWorkingSetSize / 1024 / 1024; // Convert to MB
-    }
+    size_t peakMemMB = static_cast<size_t>(getPeakMemoryUsageMB());
 
     // 2. Write to File
     std::ofstream outFile("../results.txt");
@@ -79,10 +248,17 @@ int main(int argc, char* argv[]) {
     // (A) Th�ng tin Dataset & Config
     outFile << "=== FINAL REPORT ===\n";
     outFile << "Dataset Path:      " << config.datasetPath << "\n";
-    outFile << "Total Instances:   " << instances.size() << "\n";
+    outFile << "Total Instances:   " << totalInstances << "\n";
+    if (regionMined) {
+        outFile << "Region:            " << config.region << "\n";
+        outFile << "Region Instances:  " << regionInstances << "\n";
+    }
     outFile << "Neighbor Distance: " << config.neighborDistance << "\n";
     outFile << "Min Prevalence:    " << config.minPrev << "\n";
     outFile << "Percentage Data:    " << (config.percentageData * 100) << "%\n";
+    if (resumedLevel > 0) {
+        outFile << "Resumed After Level: " << resumedLevel << "\n";
+    }
     outFile << "----------------------------------------\n";
 
     // (B) Execution Time
@@ -99,17 +275,22 @@ int main(int argc, char* argv[]) {
     if (!colocations.empty()) {
         int idx = 1;
         for (const auto& col : colocations) {
-            outFile << "[" << idx++ << "] {";
-            for (size_t i = 0; i < col.size(); ++i) {
-                outFile << (i > 0 ? ", " : "") << col[i];
-            }
-            outFile << "}\n";
+            outFile << "[" << idx++ << "] " << formatPattern(col) << "\n";
         }
     }
     else {
         outFile << "No patterns found.\n";
     }
 
+    // (F) Prevalence changes of the sliding window
+    if (!windowLog.empty()) {
+        outFile << "----------------------------------------\n";
+        outFile << "Window Updates: " << windowLog.size() << "\n";
+        for (const auto& line : windowLog) {
+            outFile << line << "\n";
+        }
+    }
+
     outFile.close();
 
     std::cout << "Done! Please check 'result.txt'.\n";
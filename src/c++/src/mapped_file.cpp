@@ -0,0 +1,59 @@
+/**
+ * @file mapped_file.cpp
+ * @brief Implementation of the read-only file mapping
+ */
+
+#include "mapped_file.h"
+#include <fstream>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile(const std::string& path) {
+#ifndef _WIN32
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Cannot open " + path);
+    }
+    struct stat info;
+    if (::fstat(fd, &info) != 0) {
+        ::close(fd);
+        throw std::runtime_error("Cannot read " + path);
+    }
+    length = static_cast<size_t>(info.st_size);
+    if (length > 0) {
+        void* mapping = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapping == MAP_FAILED) {
+            ::close(fd);
+            throw std::runtime_error("Cannot map " + path);
+        }
+        bytes = static_cast<const uint8_t*>(mapping);
+    }
+    ::close(fd);
+#else
+    std::ifstream in(path, std::ios::binary | std::ios::ate);
+    if (!in.is_open()) {
+        throw std::runtime_error("Cannot open " + path);
+    }
+    length = static_cast<size_t>(in.tellg());
+    buffer.resize(length);
+    in.seekg(0);
+    if (!in.read(reinterpret_cast<char*>(buffer.data()), length)) {
+        throw std::runtime_error("Cannot read " + path);
+    }
+    bytes = buffer.data();
+#endif
+}
+
+
+MappedFile::~MappedFile() {
+#ifndef _WIN32
+    if (bytes != nullptr) {
+        ::munmap(const_cast<uint8_t*>(bytes), length);
+    }
+#endif
+}
@@ -9,14 +9,295 @@
 #include "miner.h"
 #include "utils.h"
 #include "neighborhood_mgr.h"
+#include "star_enumerator.h"
+#include "radix_sort.h"
+#include "external_sorter.h"
+#include "pattern.h"
 #include "types.h"
 #include <algorithm>
+#include <cmath>
+#include <functional>
+#include <iterator>
+#include <numeric>
 #include <set>
 #include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
 #include <iostream>
 #include <omp.h> 
 #include <iomanip>
 #include <chrono>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+
+namespace {
+
+// Flag every sorted query that has an equal key among the sorted previous keys.
+// compare(p, q) orders previous key p against query q (<0, 0, >0). Each thread
+// merges a contiguous run of queries, starting from the first previous key not
+// below its first query.
+template <typename Compare>
+void mergeSortedKeys(int64_t prevCount, int64_t queryCount, Compare compare,
+                     const std::vector<uint32_t>& queryRows, char* keep)
+{
+    #pragma omp parallel
+    {
+        int tid = omp_get_thread_num();
+        int threads = omp_get_num_threads();
+        int64_t begin = queryCount * tid / threads;
+        int64_t end = queryCount * (tid + 1) / threads;
+
+        if (begin < end) {
+            int64_t lo = 0;
+            int64_t hi = prevCount;
+            while (lo < hi) {
+                int64_t mid = lo + (hi - lo) / 2;
+                if (compare(mid, begin) < 0) lo = mid + 1;
+                else hi = mid;
+            }
+
+            int64_t p = lo;
+            for (int64_t q = begin; q < end; ++q) {
+                while (p < prevCount && compare(p, q) < 0) ++p;
+                if (p < prevCount && compare(p, q) == 0) {
+                    keep[queryRows[q]] = 1;
+                }
+            }
+        }
+    }
+}
+
+// True if every two non-center members of a star instance are neighbors (the
+// center is a neighbor of each of them by construction)
+bool nonCentersAdjacent(const NeighborhoodMgr& neighborhoods, const SpatialInstance* const* row, size_t k)
+{
+    for (size_t i = 1; i + 1 < k; ++i) {
+        for (size_t j = i + 1; j < k; ++j) {
+            if (!neighborhoods.areNeighbors(row[i], row[j])) return false;
+        }
+    }
+    return true;
+}
+
+// Patterns hold at most kMaxPatternSize features; say so (once per process)
+// when that cap stops the lattice from growing
+void warnPatternSizeCap() {
+    static std::once_flag warned;
+    std::call_once(warned, [] {
+        std::cerr << "Warning: patterns are limited to " << kMaxPatternSize
+                  << " features; larger prevalent patterns are not mined.\n";
+    });
+}
+
+} // namespace
+
+
+void JoinlessMiner::setMemoryBudget(size_t bytes, const std::string& spillDir) {
+    memoryBudget = bytes;
+    spillDirectory = spillDir;
+}
+
+
+void JoinlessMiner::setFeatureConstraints(
+    const std::vector<FeatureType>& include,
+    const std::vector<FeatureType>& exclude)
+{
+    includeFeatures = include;
+    excludeFeatures = exclude;
+}
+
+
+void JoinlessMiner::setCoreSizes(const std::vector<size_t>& sizes) {
+    coreSizes = sizes;
+}
+
+
+void JoinlessMiner::resolveCountedSizes() {
+    if (coreSizes.empty()) {
+        countedSizes = featureSizes;
+        return;
+    }
+    if (coreSizes.size() != featureSizes.size()) {
+        throw std::invalid_argument("Core sizes do not match the features of the instances");
+    }
+    for (size_t code = 0; code < coreSizes.size(); ++code) {
+        if (coreSizes[code] == 0 || coreSizes[code] > featureSizes[code]) {
+            throw std::invalid_argument("Every feature needs between 1 and all of its instances in the core");
+        }
+    }
+    countedSizes = coreSizes;
+}
+
+
+bool JoinlessMiner::resolveConstraints() {
+    requiredCodes = Pattern();
+    excludedCodes.assign(featureTypes.size(), 0);
+
+    for (const auto& feature : excludeFeatures) {
+        auto it = std::lower_bound(featureTypes.begin(), featureTypes.end(), feature);
+        if (it != featureTypes.end() && *it == feature) {
+            excludedCodes[it - featureTypes.begin()] = 1;
+        }
+    }
+
+    std::vector<FeatureCode> required;
+    for (const auto& feature : includeFeatures) {
+        auto it = std::lower_bound(featureTypes.begin(), featureTypes.end(), feature);
+        if (it == featureTypes.end() || *it != feature) return false;
+        FeatureCode code = static_cast<FeatureCode>(it - featureTypes.begin());
+        if (excludedCodes[code]) return false;
+        required.push_back(code);
+    }
+    std::sort(required.begin(), required.end());
+    required.erase(std::unique(required.begin(), required.end()), required.end());
+    if (required.size() > kMaxPatternSize) {
+        std::cerr << "Warning: " << required.size() << " included features exceed the "
+                  << kMaxPatternSize << "-feature pattern limit; no pattern can hold them all.\n";
+        return false;
+    }
+    requiredCodes = Pattern(required.data(), required.size());
+    return true;
+}
+
+
+std::string JoinlessMiner::constraintConflict(const std::vector<SpatialInstance>& instances) const {
+    std::vector<FeatureType> types = getAllObjectTypes(instances);
+    for (const auto& feature : includeFeatures) {
+        if (std::find(excludeFeatures.begin(), excludeFeatures.end(), feature) != excludeFeatures.end()) {
+            return "included feature " + feature + " is also excluded";
+        }
+        if (!std::binary_search(types.begin(), types.end(), feature)) {
+            return "included feature " + feature + " is not in the dataset";
+        }
+    }
+    return "";
+}
+
+
+bool JoinlessMiner::requiredReachable(
+    const Pattern& prefix,
+    const std::vector<FeatureCode>& extensions,
+    size_t& firstMissing) const
+{
+    firstMissing = SIZE_MAX;
+    for (FeatureCode code : requiredCodes) {
+        if (std::binary_search(prefix.begin(), prefix.end(), code)) continue;
+        if (!std::binary_search(extensions.begin(), extensions.end(), code)) return false;
+        firstMissing = std::min<size_t>(firstMissing, code);
+    }
+    return true;
+}
+
+
+bool JoinlessMiner::satisfiesConstraints(const Pattern& codes) const {
+    for (FeatureCode code : codes) {
+        if (excludedCodes[code]) return false;
+    }
+    return std::includes(codes.begin(), codes.end(), requiredCodes.begin(), requiredCodes.end());
+}
+
+
+void JoinlessMiner::enableCheckpoints(const CheckpointStore* store, uint64_t key, bool resume) {
+    checkpoints = store;
+    checkpointKey = key;
+    resumeRequested = resume;
+}
+
+
+void JoinlessMiner::saveLevelCheckpoint(
+    int k,
+    const std::vector<Pattern>& allPrevalent,
+    const PatternRegistry& registry,
+    const InstanceTable& cliques,
+    const ExternalSorter* cliqueRuns) const
+{
+    size_t width = k + 1;
+
+    if (cliqueRuns != nullptr) {
+        ExternalSorter::Cursor cursor = cliqueRuns->cursor();
+        checkpoints->saveLevel(checkpointKey, k, allPrevalent, registry.patterns(), width, cliqueRuns->size(),
+            [&](uint32_t* block, size_t capacity) {
+                size_t n = 0;
+                for (; n < capacity && cursor.valid(); ++n, cursor.next()) {
+                    std::copy(cursor.tuple(), cursor.tuple() + width, block + n * width);
+                }
+                return n;
+            });
+    } else if (cliques.width != 0) {
+        // Rows become (pattern ID, member feature indices), the layout of the spilled tuples
+        size_t rows = cliques.rows();
+        size_t next = 0;
+        checkpoints->saveLevel(checkpointKey, k, allPrevalent, registry.patterns(), width, rows,
+            [&](uint32_t* block, size_t capacity) {
+                size_t n = 0;
+                for (; n < capacity && next < rows; ++n, ++next) {
+                    uint32_t* tuple = block + n * width;
+                    tuple[0] = cliques.patterns[next];
+                    const SpatialInstance* const* row = cliques.row(next);
+                    for (size_t slot = 0; slot < cliques.width; ++slot) {
+                        tuple[slot + 1] = row[slot]->featureIndex;
+                    }
+                }
+                return n;
+            });
+    } else {
+        // Size-2 instances are never stored
+        checkpoints->saveLevel(checkpointKey, k, allPrevalent, registry.patterns(), 0, 0,
+            [](uint32_t*, size_t) { return size_t(0); });
+    }
+}
+
+
+void JoinlessMiner::restoreCliques(
+    const LevelState& state,
+    const PatternRegistry& registry,
+    const std::vector<SpatialInstance>& instances,
+    InstanceTable& cliques,
+    std::unique_ptr<ExternalSorter>& cliqueRuns) const
+{
+    size_t width = state.tupleWidth;
+    if (width == 0) return;
+    size_t count = state.tuples.size() / width;
+
+    if (memoryBudget > 0) {
+        cliqueRuns = std::make_unique<ExternalSorter>(width, memoryBudget / 4, spillDirectory);
+        for (size_t t = 0; t < count; ++t) {
+            cliqueRuns->push(state.tuples.data() + t * width);
+        }
+        cliqueRuns->finish();
+        return;
+    }
+
+    // Instance of each (feature code, feature index)
+    std::vector<std::vector<const SpatialInstance*>> byIndex(featureSizes.size());
+    for (FeatureCode code = 0; code < featureSizes.size(); ++code) {
+        byIndex[code].resize(featureSizes[code]);
+    }
+    for (const auto& instance : instances) {
+        byIndex[instance.feature][instance.featureIndex] = &instance;
+    }
+
+    cliques.width = width - 1;
+    cliques.cells.resize(count * cliques.width);
+    cliques.patterns.resize(count);
+    for (size_t t = 0; t < count; ++t) {
+        const uint32_t* tuple = state.tuples.data() + t * width;
+        if (tuple[0] >= registry.size()) {
+            throw std::runtime_error("Checkpoint refers to an unknown candidate");
+        }
+        const Pattern& pattern = registry.pattern(tuple[0]);
+        cliques.patterns[t] = tuple[0];
+        for (size_t slot = 0; slot < cliques.width; ++slot) {
+            if (tuple[slot + 1] >= byIndex[pattern[slot]].size()) {
+                throw std::runtime_error("Checkpoint refers to an unknown instance");
+            }
+            cliques.cells[t * cliques.width + slot] = byIndex[pattern[slot]][tuple[slot + 1]];
+        }
+    }
+}
+
 
 std::vector<Colocation> JoinlessMiner::mineColocations(
     double minPrev, 
@@ -29,59 +310,173 @@ std::vector<Colocation> JoinlessMiner::mineColocations(
     // Initialize mining variables
     int k = 2;  // Start with size-2 patterns
     std::vector<FeatureType> types = getAllObjectTypes(instances);
-    std::map<FeatureType, int> featureCount = countInstancesByFeature(instances);
-    std::vector<Colocation> prevColocations;
-    std::vector<ColocationInstance> cliqueInstances;
-    std::vector<ColocationInstance> prevCliqueInstances;
-    std::vector<Colocation> allPrevalentColocations;
+    featureTypes = types;
+    featureSizes.assign(types.size(), 0);
+    for (const auto& instance : instances) {
+        featureSizes[instance.feature]++;
+    }
+    resolveCountedSizes();
+    std::vector<Pattern> prevColocations;
+
+    // Per-level scratch buffers (the keep flags of filterCliqueInstances and the
+    // per-thread row buffers of filterCliqueInstancesByAdjacency) are drawn from
+    // a per-thread arena instead of the global heap and released in one go when
+    // the level ends.
+    LevelArena scratchArena;
+    InstanceTable cliqueInstances;
+    InstanceTable prevCliqueInstances;
+    PatternRegistry prevRegistry;  // Candidates of the previous level, for the rows of prevCliqueInstances
+    std::unique_ptr<ExternalSorter> prevCliqueRuns;  // Previous level clique tuples, under a memory budget
+    std::vector<Pattern> allPrevalentColocations;
 
     // Estimate total iterations (max pattern size is number of types)
     int maxK = types.size();
     int currentIteration = 0;
     int totalIterations = 0; // Will be updated as we go
 
-    // Initialize with size-1 patterns (individual feature types)
-    for (auto t : types) prevColocations.push_back({t});
+    // Feature constraints: excluded features never become seeds, and with included
+    // features the search starts from the pattern of exactly those features
+    if (!resolveConstraints()) {
+        return {};
+    }
+    bool constrained = !requiredCodes.empty();
+    if (constrained) {
+        k = std::max<int>(2, static_cast<int>(requiredCodes.size()));
+        prevColocations.push_back(requiredCodes);
+    } else {
+        // Initialize with size-1 patterns (individual feature types)
+        for (FeatureCode code = 0; code < types.size(); ++code) {
+            if (excludedCodes[code]) continue;
+            Pattern single;
+            single.push_back(code);
+            prevColocations.push_back(single);
+        }
+    }
+
+    // Continue after the last level a previous run with the same fingerprint completed
+    resumedFrom = 0;
+    LevelState resumed;
+    if (checkpoints != nullptr && resumeRequested && checkpoints->loadLevel(checkpointKey, resumed)) {
+        allPrevalentColocations = resumed.prevalent;
+        prevColocations.clear();
+        for (const auto& pattern : allPrevalentColocations) {
+            if (pattern.size() == resumed.level) prevColocations.push_back(pattern);
+        }
+        for (const auto& cand : resumed.candidates) {
+            prevRegistry.add(cand);
+        }
+        restoreCliques(resumed, prevRegistry, instances, prevCliqueInstances, prevCliqueRuns);
+        resumedFrom = resumed.level;
+        k = static_cast<int>(resumed.level) + 1;
+        resumed = LevelState();
+    }
 
     while (!prevColocations.empty()) {
         currentIteration++;
         totalIterations = currentIteration;
 
-        std::vector<ColocationInstance> starInstances;
-		// 1. Generate candidate patterns of size k
-        std::vector<Colocation> candidates = generateCandidates(prevColocations);
+        InstanceTable starInstances;
+        starInstances.width = k;
+		// 1. Generate candidate patterns of size k (of the constrained sublattice
+		//    if features are included; the first level is the included pattern)
+        std::vector<Pattern> candidates;
+        if (!constrained) {
+            candidates = generateCandidatePatterns(prevColocations);
+        } else if (static_cast<size_t>(k) == requiredCodes.size()) {
+            candidates.push_back(requiredCodes);
+        } else {
+            candidates = generateConstrainedCandidates(prevColocations);
+        }
 
         if (candidates.empty()) {
             break;
         }
-		// 2. Filter star instances for each candidate
-        for (auto t : types) {
-            for (const auto& starNeigh : neighborhoodMgr->getAllStarNeighborhoods()) {
-                if (starNeigh.first == t) {
-                    std::vector<ColocationInstance> found = filterStarInstances(candidates, starNeigh);
-                    starInstances.insert(starInstances.end(), found.begin(), found.end());
+
+        PatternRegistry registry;
+        if (k == 2) {
+			// 2-4. Size-2 participation follows directly from the star neighbor
+			//      lists, so no star or clique instance is materialized
+            prevColocations = selectPrevPairs(
+                neighborhoodMgr->getAllStarNeighborhoods(),
+                candidates,
+                minPrev
+            );
+        } else {
+			// 2. Select prevalent colocations using coarse filter, marking star
+			//    participants directly instead of enumerating star instances
+            candidates = selectCoarsePrevColocations(
+                candidates,
+                neighborhoodMgr->getAllStarNeighborhoods(),
+                minPrev
+            );
+
+            // From here on a candidate is known by its dense ID in the level's registry
+            for (const auto& cand : candidates) {
+                registry.add(cand);
+            }
+
+            if (memoryBudget > 0) {
+                // 3-5. Under a memory budget, star and clique instances live in
+                //      spilling sorters and the clique check is an external merge
+                //      (or, when constrained, a neighbor graph check)
+                auto cliqueRuns = std::make_unique<ExternalSorter>(k + 1, memoryBudget / 4, spillDirectory);
+                prevColocations = selectPrevColocationsOutOfCore(
+                    registry,
+                    prevRegistry,
+                    *neighborhoodMgr,
+                    constrained ? nullptr : prevCliqueRuns.get(),
+                    *cliqueRuns,
+                    minPrev
+                );
+                prevCliqueRuns = std::move(cliqueRuns);
+                allPrevalentColocations.insert(
+                    allPrevalentColocations.end(),
+                    prevColocations.begin(),
+                    prevColocations.end()
+                );
+                prevRegistry = std::move(registry);
+                if (checkpoints != nullptr) {
+                    saveLevelCheckpoint(k, allPrevalentColocations, prevRegistry, prevCliqueInstances, prevCliqueRuns.get());
                 }
+                scratchArena.release();
+                k++;
+                continue;
             }
-        }
 
-        if (k==2){
-            cliqueInstances = starInstances;
-        }else{
-			// 3. Select prevalent colocations using coarse filter
-            candidates = selectPrevColocations(candidates, starInstances, minPrev, featureCount);
-			// 4. Filter clique instances for candidates
-            cliqueInstances = filterCliqueInstances(
-                candidates,
-                starInstances,
-                prevCliqueInstances
+			// 3. Filter star instances for each (coarse prevalent) candidate
+            for (auto t : types) {
+                for (const auto& starNeigh : neighborhoodMgr->getAllStarNeighborhoods()) {
+                    if (starNeigh.first == t) {
+                        filterStarInstances(registry, starNeigh, starInstances);
+                    }
+                }
+            }
+
+			// 4. Filter clique instances for candidates; size-2 instances were never
+			//    stored, so at k=3 the remaining edge is checked in the neighbor graph,
+			//    as are all non-center edges when constrained (suffixes may lie
+			//    outside the sublattice)
+            if (k == 3 || constrained) {
+                cliqueInstances = filterCliqueInstancesByAdjacency(
+                    starInstances,
+                    *neighborhoodMgr,
+                    scratchArena
+                );
+            } else {
+                cliqueInstances = filterCliqueInstances(
+                    registry,
+                    prevRegistry,
+                    starInstances,
+                    prevCliqueInstances,
+                    scratchArena
+                );
+            }
+            prevColocations = selectPrevColocations(
+                registry,
+                cliqueInstances,
+                minPrev
             );
         }
-        prevColocations = selectPrevColocations(
-            candidates,
-            cliqueInstances,
-            minPrev,
-            featureCount
-        );
         if (!prevColocations.empty()) {
              allPrevalentColocations.insert(
                  allPrevalentColocations.end(), 
@@ -90,288 +485,1229 @@ std::vector<Colocation> JoinlessMiner::mineColocations(
              );
         } 
         prevCliqueInstances = std::move(cliqueInstances);
+        cliqueInstances = InstanceTable();
+        prevRegistry = std::move(registry);
+        if (checkpoints != nullptr) {
+            saveLevelCheckpoint(k, allPrevalentColocations, prevRegistry, prevCliqueInstances, nullptr);
+        }
+
+        // Nothing allocated from this level's scratch is referenced any more
+        scratchArena.release();
         k++;
     }
-    return allPrevalentColocations;
+    return decodePatterns(allPrevalentColocations);
+}
+
+
+std::vector<Colocation> JoinlessMiner::mineColocationsDepthFirst(
+    double minPrev,
+    NeighborhoodMgr* neighborhoodMgr,
+    const std::vector<SpatialInstance>& instances
+) {
+    std::vector<FeatureType> types = getAllObjectTypes(instances);
+    featureTypes = types;
+    featureSizes.assign(types.size(), 0);
+    for (const auto& instance : instances) {
+        featureSizes[instance.feature]++;
+    }
+    resolveCountedSizes();
+    size_t numFeatures = types.size();
+
+    // Excluded features never enter a pair, hence no class; classes and
+    // subtrees that cannot reach every included feature are skipped
+    if (!resolveConstraints()) {
+        return {};
+    }
+    std::vector<Pattern> seeds;
+    for (FeatureCode code = 0; code < numFeatures; ++code) {
+        if (excludedCodes[code]) continue;
+        Pattern single;
+        single.push_back(code);
+        seeds.push_back(single);
+    }
+
+    // ========================================================================
+    // STEP 1: Size-2 patterns, which also define the prefix classes
+    // ========================================================================
+    std::vector<Pattern> pairCodes = selectPrevPairs(
+        neighborhoodMgr->getAllStarNeighborhoods(),
+        generateCandidatePatterns(seeds),
+        minPrev
+    );
+
+    std::vector<char> pairPrevalent(numFeatures * numFeatures, 0);
+    for (const auto& pair : pairCodes) {
+        pairPrevalent[pair[0] * numFeatures + pair[1]] = 1;
+    }
+
+    auto starsByFeature = starsByFeatureCode(neighborhoodMgr->getAllStarNeighborhoods());
+
+    // ========================================================================
+    // STEP 2: Mine every prefix class {a, b} to completion as one task
+    // ========================================================================
+    int64_t numClasses = static_cast<int64_t>(pairCodes.size());
+    std::vector<std::vector<Pattern>> classPatterns(numClasses);
+
+    #pragma omp parallel for schedule(dynamic, 1)
+    for (int64_t c = 0; c < numClasses; ++c) {
+        const Pattern& prefix = pairCodes[c];
+        FeatureCode a = prefix[0];
+        FeatureCode b = prefix[1];
+
+        // A pattern {a, b, y} needs both {a, y} and {b, y} to be prevalent
+        std::vector<FeatureCode> extensions;
+        for (size_t y = b + 1; y < numFeatures; ++y) {
+            if (pairPrevalent[a * numFeatures + y] && pairPrevalent[b * numFeatures + y]) {
+                extensions.push_back(static_cast<FeatureCode>(y));
+            }
+        }
+        if (extensions.empty() || starsByFeature[a] == nullptr) continue;
+
+        // Only later features join the class, so each included feature must be
+        // a, b or an extension; classes starting past min(requiredCodes) never are
+        size_t firstMissing;
+        if (!requiredReachable(prefix, extensions, firstMissing)) continue;
+
+        // Size-2 instances of the class, scoped to this task
+        InstanceTable prefixInstances;
+        prefixInstances.width = 2;
+        for (const auto& star : *starsByFeature[a]) {
+            const NeighborGroup* group = star.findGroup(b);
+            if (group == nullptr) continue;
+            for (uint32_t n = group->begin; n < group->end; ++n) {
+                prefixInstances.cells.push_back(star.center);
+                prefixInstances.cells.push_back(star.neighbors[n]);
+            }
+        }
+
+        mineSubtree(prefix, prefixInstances, extensions, *neighborhoodMgr,
+                    minPrev, pairPrevalent, classPatterns[c]);
+    }
+
+    // ========================================================================
+    // STEP 3: Report patterns in level-wise order (by size, then by name)
+    // ========================================================================
+    // Pairs and the inner nodes of constrained subtrees may still lack an
+    // included feature
+    std::vector<Pattern> found = std::move(pairCodes);
+    for (auto& patterns : classPatterns) {
+        found.insert(found.end(), patterns.begin(), patterns.end());
+    }
+    found.erase(std::remove_if(found.begin(), found.end(), [this](const Pattern& pattern) {
+        return !satisfiesConstraints(pattern);
+    }), found.end());
+    std::sort(found.begin(), found.end(), [](const Pattern& x, const Pattern& y) {
+        if (x.size() != y.size()) return x.size() < y.size();
+        return x < y;
+    });
+
+    return decodePatterns(found);
+}
+
+
+std::vector<double> JoinlessMiner::participationIndices(
+    const std::vector<Colocation>& patterns,
+    NeighborhoodMgr* neighborhoodMgr,
+    const std::vector<SpatialInstance>& instances
+) {
+    featureTypes = getAllObjectTypes(instances);
+    featureSizes.assign(featureTypes.size(), 0);
+    for (const auto& instance : instances) {
+        featureSizes[instance.feature]++;
+    }
+    resolveCountedSizes();
+    auto starsByFeature = starsByFeatureCode(neighborhoodMgr->getAllStarNeighborhoods());
+
+    int64_t numPatterns = static_cast<int64_t>(patterns.size());
+    std::vector<double> indices(numPatterns, 0.0);
+
+    #pragma omp parallel for schedule(dynamic, 1)
+    for (int64_t p = 0; p < numPatterns; ++p) {
+        Pattern codes = encodePattern(patterns[p]);
+        if (codes.size() < 2 || starsByFeature[codes[0]] == nullptr) continue;
+
+        // Size-2 instances straight from the stars, then one feature at a time
+        InstanceTable table;
+        table.width = 2;
+        for (const auto& star : *starsByFeature[codes[0]]) {
+            const NeighborGroup* group = star.findGroup(codes[1]);
+            if (group == nullptr) continue;
+            for (uint32_t n = group->begin; n < group->end; ++n) {
+                table.cells.push_back(star.center);
+                table.cells.push_back(star.neighbors[n]);
+            }
+        }
+
+        Pattern prefix = codes;
+        while (prefix.size() > 2) prefix.pop_back();
+        for (size_t slot = 2; slot < codes.size(); ++slot) {
+            prefix.push_back(codes[slot]);
+            InstanceTable extended;
+            extendCliqueInstances(table, prefix, *neighborhoodMgr, 0.0, &extended);
+            table = std::move(extended);
+        }
+
+        // The index is the smallest participation ratio over the features
+        double index = 1.0;
+        for (size_t slot = 0; slot < codes.size(); ++slot) {
+            ParticipationBitmap participants;
+            participants.reset(featureSizes[codes[slot]], countedSizes[codes[slot]]);
+            for (size_t r = 0; r < table.rows(); ++r) {
+                participants.set(table.row(r)[slot]->featureIndex);
+            }
+            index = std::min(index, static_cast<double>(participants.count) / countedSizes[codes[slot]]);
+        }
+        indices[p] = index;
+    }
+    return indices;
+}
+
+
+void JoinlessMiner::mineSubtree(
+    const Pattern& prefix,
+    const InstanceTable& prefixInstances,
+    const std::vector<FeatureCode>& extensions,
+    const NeighborhoodMgr& neighborhoods,
+    double minPrev,
+    const std::vector<char>& pairPrevalent,
+    std::vector<Pattern>& found)
+{
+    size_t numFeatures = featureTypes.size();
+    if (prefix.size() >= kMaxPatternSize) {
+        if (!extensions.empty()) warnPatternSizeCap();
+        return;
+    }
+    Pattern child = prefix;
+
+    // With included features, every pattern below the prefix holds the
+    // smallest one it lacks, so only children up to that feature are mined;
+    // later extensions stay undecided as members of their subtrees
+    size_t firstMissing;
+    if (!requiredReachable(prefix, extensions, firstMissing)) return;
+
+    // Decide every one-feature extension first, without keeping its instances
+    std::vector<FeatureCode> prevalentExtensions;
+    size_t decided = 0;
+    for (; decided < extensions.size() && extensions[decided] <= firstMissing; ++decided) {
+        FeatureCode y = extensions[decided];
+        child = prefix;
+        child.push_back(y);
+        if (extendCliqueInstances(prefixInstances, child, neighborhoods, minPrev, nullptr)) {
+            prevalentExtensions.push_back(y);
+            found.push_back(child);
+        }
+    }
+    std::vector<FeatureCode> memberExtensions(prevalentExtensions);
+    memberExtensions.insert(memberExtensions.end(), extensions.begin() + decided, extensions.end());
+
+    // Then descend into each prevalent child in turn; only the tables on the
+    // current path are ever resident
+    for (size_t i = 0; i < prevalentExtensions.size(); ++i) {
+        FeatureCode y = prevalentExtensions[i];
+
+        std::vector<FeatureCode> childExtensions;
+        for (size_t j = i + 1; j < memberExtensions.size(); ++j) {
+            if (pairPrevalent[y * numFeatures + memberExtensions[j]]) {
+                childExtensions.push_back(memberExtensions[j]);
+            }
+        }
+        if (childExtensions.empty()) continue;
+
+        child = prefix;
+        child.push_back(y);
+        InstanceTable childInstances;
+        extendCliqueInstances(prefixInstances, child, neighborhoods, minPrev, &childInstances);
+        mineSubtree(child, childInstances, childExtensions, neighborhoods,
+                    minPrev, pairPrevalent, found);
+    }
+}
+
+
+bool JoinlessMiner::extendCliqueInstances(
+    const InstanceTable& prefixInstances,
+    const Pattern& pattern,
+    const NeighborhoodMgr& neighborhoods,
+    double minPrev,
+    InstanceTable* extended)
+{
+    size_t k = pattern.size();
+    size_t width = prefixInstances.width;
+    FeatureCode feature = pattern.back();
+
+    std::vector<ParticipationBitmap> slots(k);
+    std::vector<size_t> need(k);
+    for (size_t slot = 0; slot < k; ++slot) {
+        slots[slot].reset(featureSizes[pattern[slot]], countedSizes[pattern[slot]]);
+        need[slot] = participationThreshold(minPrev, countedSizes[pattern[slot]]);
+    }
+    if (extended != nullptr) {
+        extended->width = k;
+    }
+
+    size_t rows = prefixInstances.rows();
+    for (size_t r = 0; r < rows; ++r) {
+        const SpatialInstance* const* row = prefixInstances.row(r);
+
+        // Candidates are the neighbors of the new feature in the first member's
+        // star; each must also be a neighbor of every other member
+        const StarNeighborhood* star = neighborhoods.findStar(row[0]);
+        const NeighborGroup* group = (star != nullptr) ? star->findGroup(feature) : nullptr;
+        if (group != nullptr) {
+            for (uint32_t n = group->begin; n < group->end; ++n) {
+                const SpatialInstance* candidate = star->neighbors[n];
+                bool clique = true;
+                for (size_t j = 1; j < width && clique; ++j) {
+                    clique = neighborhoods.areNeighbors(row[j], candidate);
+                }
+                if (!clique) continue;
+
+                for (size_t j = 0; j < width; ++j) {
+                    slots[j].set(row[j]->featureIndex);
+                }
+                slots[width].set(candidate->featureIndex);
+                if (extended != nullptr) {
+                    extended->cells.insert(extended->cells.end(), row, row + width);
+                    extended->cells.push_back(candidate);
+                }
+            }
+        }
+
+        if (extended == nullptr) {
+            // Prevalent as soon as every feature has enough participants
+            if (thresholdsReached(slots.data(), need.data(), k)) return true;
+
+            // Infeasible once a prefix feature cannot catch up: each remaining
+            // prefix row adds at most one participant to it
+            size_t remaining = rows - r - 1;
+            for (size_t j = 0; j < width; ++j) {
+                if (slots[j].count + remaining < need[j]) return false;
+            }
+        }
+    }
+    return thresholdsReached(slots.data(), need.data(), k);
 }
 
 
 std::vector<Colocation> JoinlessMiner::generateCandidates(
     const std::vector<Colocation>& prevPrevalent) 
 {
+    // Code the features of the given patterns in name order, generate over
+    // codes, and translate back
+    std::set<FeatureType> names;
+    for (const auto& pattern : prevPrevalent) {
+        names.insert(pattern.begin(), pattern.end());
+    }
+    std::vector<FeatureType> dictionary(names.begin(), names.end());
+
+    std::vector<Pattern> prevPatterns;
+    for (const auto& pattern : prevPrevalent) {
+        std::set<FeatureType> sorted(pattern.begin(), pattern.end());
+        Pattern codes;
+        for (const auto& feature : sorted) {
+            codes.push_back(static_cast<FeatureCode>(
+                std::lower_bound(dictionary.begin(), dictionary.end(), feature) - dictionary.begin()));
+        }
+        prevPatterns.push_back(codes);
+    }
+
     std::vector<Colocation> candidates;
-    
+    for (const auto& pattern : generateCandidatePatterns(prevPatterns)) {
+        Colocation candidate;
+        for (FeatureCode code : pattern) {
+            candidate.push_back(dictionary[code]);
+        }
+        candidates.push_back(std::move(candidate));
+    }
+    return candidates;
+}
+
+
+std::vector<Pattern> JoinlessMiner::generateCandidatePatterns(
+    const std::vector<Pattern>& prevPrevalent)
+{
+    std::vector<Pattern> candidates;
+
     if (prevPrevalent.empty()) {
         return candidates;
     }
-    
-    size_t patternSize = prevPrevalent[0].size();
-    
-    std::set<Colocation> prevSet(prevPrevalent.begin(), prevPrevalent.end());
-    
-    // Generate candidate
-    for (size_t i = 0; i < prevPrevalent.size(); i++) {
-        for (size_t j = i + 1; j < prevPrevalent.size(); j++) {
-            // Take prefix of k-1 first element
-            Colocation prefix1(prevPrevalent[i].begin(), 
-                             prevPrevalent[i].end() - 1);
-            Colocation prefix2(prevPrevalent[j].begin(), 
-                             prevPrevalent[j].end() - 1);
-            
-            // Just join when the prefix is equal
-            if (prefix1 != prefix2) {
-                continue;
+
+    // Patterns sharing a prefix are adjacent once sorted
+    std::vector<Pattern> sorted(prevPrevalent);
+    std::sort(sorted.begin(), sorted.end());
+    sorted.erase(std::unique(sorted.begin(), sorted.end()), sorted.end());
+
+    // At the size cap, warn if any two patterns would still have been joined
+    if (sorted[0].size() >= kMaxPatternSize) {
+        for (size_t i = 0; i + 1 < sorted.size(); ++i) {
+            if (std::equal(sorted[i].begin(), sorted[i].end() - 1, sorted[i + 1].begin())) {
+                warnPatternSizeCap();
+                break;
             }
-            
-            // Generate new candidate
-            std::set<FeatureType> candidateSet(prevPrevalent[i].begin(), 
-                                              prevPrevalent[i].end());
-            candidateSet.insert(prevPrevalent[j].back());
-            
-            if (candidateSet.size() != patternSize + 1) {
-                continue;
+        }
+        return candidates;
+    }
+
+    std::unordered_set<Pattern, PatternHash> prevSet(sorted.begin(), sorted.end());
+    size_t patternSize = sorted[0].size();
+
+    // Generate candidate
+    for (size_t i = 0; i < sorted.size(); i++) {
+        for (size_t j = i + 1; j < sorted.size(); j++) {
+            // Just join when the prefix of k-1 first elements is equal
+            if (!std::equal(sorted[i].begin(), sorted[i].end() - 1, sorted[j].begin())) {
+                break;
             }
-            
-            Colocation candidate(candidateSet.begin(), candidateSet.end());
-            
-            // APRIORI PRUNING
+
+            // New candidate: the shared prefix and both last features, in order
+            Pattern candidate = sorted[i];
+            candidate.push_back(sorted[j].back());
+
+            // APRIORI PRUNING: every subset without one feature must be prevalent
+            // (the two without either last feature are sorted[i] and sorted[j])
             bool allSubsetsValid = true;
-            std::vector<FeatureType> candFeatures = candidate;
-            
-            for (size_t idx = 0; idx < candFeatures.size(); idx++) {
-                Colocation subset = candFeatures; 
-                subset.erase(subset.begin() + idx);
-                
-                if (prevSet.find(subset) == prevSet.end()) {
+            for (size_t idx = 0; idx + 2 < patternSize + 1; idx++) {
+                if (prevSet.find(candidate.without(idx)) == prevSet.end()) {
                     allSubsetsValid = false;
                     break;
                 }
             }
-            
+
             if (allSubsetsValid) {
                 candidates.push_back(candidate);
             }
         }
     }
-    
-    // Remove duplicate
-    std::sort(candidates.begin(), candidates.end());
-    candidates.erase(std::unique(candidates.begin(), candidates.end()), 
-                     candidates.end());
 
     return candidates;
 }
 
 
-std::vector<ColocationInstance> JoinlessMiner::filterStarInstances(
-    const std::vector<Colocation>& candidates, 
-    const std::pair<FeatureType, std::vector<StarNeighborhood>>& starNeigh) 
+std::vector<Pattern> JoinlessMiner::generateConstrainedCandidates(
+    const std::vector<Pattern>& prevPrevalent) const
+{
+    std::vector<Pattern> candidates;
+
+    if (prevPrevalent.empty()) {
+        return candidates;
+    }
+
+    // Free parts of the prevalent patterns
+    std::vector<Pattern> freeParts;
+    std::vector<FeatureCode> codes;
+    for (const auto& pattern : prevPrevalent) {
+        codes.clear();
+        std::set_difference(pattern.begin(), pattern.end(),
+                            requiredCodes.begin(), requiredCodes.end(),
+                            std::back_inserter(codes));
+        freeParts.emplace_back(codes.data(), codes.size());
+    }
+
+    std::vector<Pattern> extensions;
+    if (freeParts[0].empty()) {
+        for (FeatureCode code = 0; code < featureTypes.size(); ++code) {
+            if (excludedCodes[code] || std::binary_search(requiredCodes.begin(), requiredCodes.end(), code)) {
+                continue;
+            }
+            Pattern single;
+            single.push_back(code);
+            extensions.push_back(single);
+        }
+    } else {
+        extensions = generateCandidatePatterns(freeParts);
+    }
+
+    bool capped = false;
+    for (const auto& rest : extensions) {
+        codes.clear();
+        std::merge(requiredCodes.begin(), requiredCodes.end(),
+                   rest.begin(), rest.end(),
+                   std::back_inserter(codes));
+        if (codes.size() > kMaxPatternSize) {
+            capped = true;
+            continue;
+        }
+        candidates.emplace_back(codes.data(), codes.size());
+    }
+    if (capped) {
+        warnPatternSizeCap();
+    }
+
+    // Level-wise results are reported in candidate order, i.e. by name
+    std::sort(candidates.begin(), candidates.end());
+    return candidates;
+}
+
+
+std::vector<const std::vector<StarNeighborhood>*> JoinlessMiner::starsByFeatureCode(
+    const std::unordered_map<FeatureType, std::vector<StarNeighborhood>>& starNeighborhoods) const
 {
-    std::vector<ColocationInstance> filteredInstances;
-    FeatureType centerType = starNeigh.first;
+    std::vector<const std::vector<StarNeighborhood>*> starsByFeature(featureTypes.size(), nullptr);
+    for (const auto& entry : starNeighborhoods) {
+        if (!entry.second.empty()) {
+            starsByFeature[entry.second.front().center->feature] = &entry.second;
+        }
+    }
+    return starsByFeature;
+}
+
+
+Pattern JoinlessMiner::encodePattern(const Colocation& pattern) const {
+    Pattern codes;
+    for (const auto& feature : pattern) {
+        auto it = std::lower_bound(featureTypes.begin(), featureTypes.end(), feature);
+        codes.push_back(static_cast<FeatureCode>(it - featureTypes.begin()));
+    }
+    return codes;
+}
+
+
+std::vector<Colocation> JoinlessMiner::decodePatterns(const std::vector<Pattern>& patterns) const {
+    std::vector<Colocation> decoded;
+    decoded.reserve(patterns.size());
+    for (const auto& pattern : patterns) {
+        Colocation colocation;
+        colocation.reserve(pattern.size());
+        for (FeatureCode code : pattern) {
+            colocation.push_back(featureTypes[code]);
+        }
+        decoded.push_back(std::move(colocation));
+    }
+    return decoded;
+}
+
+
+size_t JoinlessMiner::participationThreshold(double minPrev, size_t featureSize) {
+    if (minPrev <= 0.0) return 0;
+
+    // Smallest count whose ratio passes the same comparison the ratio test uses
+    size_t need = static_cast<size_t>(std::ceil(minPrev * (double)featureSize));
+    while (need > 0 && (double)(need - 1) / (double)featureSize >= minPrev) --need;
+    while (need <= featureSize && (double)need / (double)featureSize < minPrev) ++need;
+    return need;
+}
+
+
+bool JoinlessMiner::thresholdsReached(const ParticipationBitmap* slots, const size_t* need, size_t k) {
+    for (size_t slot = 0; slot < k; ++slot) {
+        if (slots[slot].count < need[slot]) return false;
+    }
+    return true;
+}
+
+
+bool JoinlessMiner::requiredFeatureMask(const Pattern& codes, FeatureMask& required) {
+    required = FeatureMask();
+    for (size_t slot = 1; slot < codes.size(); ++slot) {
+        if (codes[slot] >= FeatureMask::kCapacity) {
+            return false;
+        }
+        required.set(codes[slot]);
+    }
+    return true;
+}
+
+
+void JoinlessMiner::filterStarInstances(
+    const PatternRegistry& registry,
+    const std::pair<FeatureType, std::vector<StarNeighborhood>>& starNeigh,
+    InstanceTable& filteredInstances) 
+{
+    if (starNeigh.second.empty()) return;
+    FeatureCode centerFeature = starNeigh.second.front().center->feature;
     
-    // Filter candidates to only those with this center type as first element
-    std::vector<const Colocation*> relevantCandidates;
-    for (const auto& cand : candidates) {
-        if (!cand.empty() && cand[0] == centerType) {
-            relevantCandidates.push_back(&cand);
+    // Filter candidates to only those with this center type as first element,
+    // with their feature codes for the star group lookups and the mask of
+    // features a star needs to hold them (empty when some feature is not
+    // representable, so that bind() alone decides)
+    std::vector<PatternId> relevantIds;
+    std::vector<Pattern> relevantCandidates;
+    std::vector<FeatureMask> requiredMasks;
+    for (PatternId id = 0; id < registry.size(); ++id) {
+        if (registry.pattern(id)[0] == centerFeature) {
+            relevantIds.push_back(id);
+            relevantCandidates.push_back(registry.pattern(id));
+            requiredMasks.emplace_back();
+            if (!requiredFeatureMask(relevantCandidates.back(), requiredMasks.back())) {
+                requiredMasks.back() = FeatureMask();
+            }
         }
     }
 
-    if (relevantCandidates.empty()) return filteredInstances;
+    if (relevantCandidates.empty()) return;
 
-    // Iterate through each star neighborhood
+    // Iterate through each star neighborhood; its neighbors are already grouped
+    // by feature, so each candidate is a product of contiguous neighbor ranges
+    StarEnumerator enumerator;
     for (const auto& star : starNeigh.second) {
-        
-        // Build a map of neighbors by feature type for fast lookup
-        // Using const pointer since star is const
-        std::unordered_map<FeatureType, std::vector<const SpatialInstance*>> neighborMap;
-        
-        for (auto neighbor : star.neighbors) {
-            neighborMap[neighbor->type].push_back(neighbor);
-        }
 
         // Check each relevant candidate pattern
-        for (const auto* candPtr : relevantCandidates) {
-            const auto& candidate = *candPtr;
-            
-            std::vector<const SpatialInstance*> currentInstance;
-            currentInstance.reserve(candidate.size());
-            
-            // Add center instance as first element
-            currentInstance.push_back(star.center);
+        for (size_t c = 0; c < relevantCandidates.size(); ++c) {
+            // Skip at once if the star lacks one of the candidate's features:
+            // one mask test, or the group lookups in bind() for large vocabularies
+            if (!star.presence.contains(requiredMasks[c])) continue;
+            if (!enumerator.bind(star, relevantCandidates[c])) continue;
 
-			// Recursive function to find combinations
-            findCombinations(candidate, 1, currentInstance, neighborMap, filteredInstances);
+            size_t rows = enumerator.emit(filteredInstances.cells);
+            filteredInstances.patterns.insert(filteredInstances.patterns.end(), rows, relevantIds[c]);
         }
     }
-
-    return filteredInstances;
 }
 
 
-std::vector<ColocationInstance> JoinlessMiner::filterCliqueInstances(
-    const std::vector<Colocation>& candidates,
-    const std::vector<ColocationInstance>& instances,
-    const std::vector<ColocationInstance>& prevInstances
+InstanceTable JoinlessMiner::filterCliqueInstances(
+    const PatternRegistry& registry,
+    const PatternRegistry& prevRegistry,
+    const InstanceTable& instances,
+    const InstanceTable& prevInstances,
+    LevelArena& arena
 ) {
+    size_t width = instances.width;
+    size_t prevWidth = prevInstances.width;
+    int64_t rows = static_cast<int64_t>(instances.rows());
+    int64_t prevRows = static_cast<int64_t>(prevInstances.rows());
+
     // ========================================================================
-	// STEP 1: PREPARE LOOKUP STRUCTURES
+	// STEP 1: PREPARE TUPLE LAYOUT
     // ========================================================================
+    // A row is identified by its pattern ID followed by the feature index of each
+    // member: within one pattern every slot has a fixed feature, so the feature
+    // index alone identifies the instance
 
-	// 1.1. Create a set of valid candidate patterns for quick lookup
-    std::set<Colocation> validCandidatePatterns(candidates.begin(), candidates.end());
+	// 1.1. ID of every candidate's (k-1)-suffix (the candidate without its
+	//      center feature) in the previous level
+    std::vector<PatternId> suffixIds(registry.size());
+    for (PatternId id = 0; id < registry.size(); ++id) {
+        suffixIds[id] = prevRegistry.find(registry.pattern(id).without(0));
+    }
 
-	// 1.2. Create a set of previous instances for quick lookup
-    std::set<std::vector<std::string>> validPrevIds;
-    for (const auto& prevInst : prevInstances) {
-        std::vector<std::string> ids;
-        ids.reserve(prevInst.size());
-        for (const auto* ptr : prevInst) {
-            ids.push_back(ptr->id);
+	// 1.2. Star instances that can match at all: their suffix pattern exists
+    std::vector<uint32_t> queryRows;
+    queryRows.reserve(static_cast<size_t>(rows));
+    for (int64_t i = 0; i < rows; ++i) {
+        if (suffixIds[instances.patterns[i]] != PatternRegistry::kNone) {
+            queryRows.push_back(static_cast<uint32_t>(i));
         }
-        validPrevIds.insert(ids);
     }
+    int64_t queries = static_cast<int64_t>(queryRows.size());
 
-    // ========================================================================
-	// STEP 2: PREPARE THREAD BUFFERS
-    // ========================================================================
-    int num_threads = omp_get_max_threads();
-    std::vector<std::vector<ColocationInstance>> thread_buffers(num_threads);
+	// 1.3. Tuples whose fields fit in 64 bits are packed into a single key
+    auto bitWidth = [](uint64_t value) {
+        int bits = 0;
+        while (bits < 64 && (value >> bits) != 0) ++bits;
+        return bits;
+    };
+    int patternBits = bitWidth(prevRegistry.size());
+    int memberBits = bitWidth(*std::max_element(featureSizes.begin(), featureSizes.end()));
+    bool singleWord = patternBits + static_cast<int>(prevWidth) * memberBits <= 64;
 
-    // ========================================================================
-	// STEP 3: PARALLEL FILTERING
-    // ========================================================================
-    #pragma omp parallel for
-    for (size_t i = 0; i < instances.size(); ++i) {
-        const auto& instance = instances[i];
-        int thread_id = omp_get_thread_num();
+    std::pmr::vector<char> keep(static_cast<size_t>(rows), 0, arena.resource(0));
 
-        // Safety check
-        if (instance.size() < 2) continue;
+    if (singleWord) {
+        // ====================================================================
+        // STEP 2: PACK, RADIX SORT AND MERGE 64-BIT KEYS
+        // ====================================================================
+        std::vector<uint64_t> prevKeys(static_cast<size_t>(prevRows));
+        std::vector<uint32_t> prevOrder(static_cast<size_t>(prevRows));
+        std::vector<uint64_t> queryKeys(static_cast<size_t>(queries));
 
-        Colocation currentPattern;
-        currentPattern.reserve(instance.size());
-        for (const auto* ptr : instance) {
-            currentPattern.push_back(ptr->type);
-        }
+        // Packing loops are specialized on the tuple width so they unroll
+        dispatchPatternSize(width, [&](auto fixed) {
+            const size_t members = decltype(fixed)::value ? decltype(fixed)::value - 1 : prevWidth;
+            auto packKey = [&](PatternId pattern, const SpatialInstance* const* row) {
+                uint64_t key = pattern;
+                for (size_t j = 0; j < members; ++j) {
+                    key = (key << memberBits) | row[j]->featureIndex;
+                }
+                return key;
+            };
 
-		// If current pattern is not a valid candidate, skip
-        if (validCandidatePatterns.find(currentPattern) == validCandidatePatterns.end()) {
-            continue;
-        }
+            #pragma omp parallel for
+            for (int64_t r = 0; r < prevRows; ++r) {
+                prevKeys[r] = packKey(prevInstances.patterns[r], prevInstances.row(r));
+                prevOrder[r] = static_cast<uint32_t>(r);
+            }
 
-        std::vector<std::string> subInstanceIds;
-        subInstanceIds.reserve(instance.size() - 1);
+            #pragma omp parallel for
+            for (int64_t q = 0; q < queries; ++q) {
+                uint32_t i = queryRows[q];
+                queryKeys[q] = packKey(suffixIds[instances.patterns[i]], instances.row(i) + 1);
+            }
+        });
 
-		// Generate (k-1)-subset by removing the first instance
-        for (size_t j = 1; j < instance.size(); ++j) {
-            subInstanceIds.push_back(instance[j]->id);
+        radixSortPairs(prevKeys, prevOrder);
+        std::vector<uint32_t>().swap(prevOrder);
+        radixSortPairs(queryKeys, queryRows);
+
+        mergeSortedKeys(prevRows, queries,
+            [&](int64_t p, int64_t q) {
+                return (prevKeys[p] < queryKeys[q]) ? -1 : (prevKeys[p] > queryKeys[q]) ? 1 : 0;
+            },
+            queryRows, keep.data());
+    } else {
+        // ====================================================================
+        // STEP 2: PACK, RADIX SORT AND MERGE MULTI-WORD TUPLES
+        // ====================================================================
+        size_t tupleWidth = prevWidth + 1;
+
+        std::vector<uint32_t> prevTuples(static_cast<size_t>(prevRows) * tupleWidth);
+        #pragma omp parallel for
+        for (int64_t r = 0; r < prevRows; ++r) {
+            const SpatialInstance* const* row = prevInstances.row(r);
+            uint32_t* tuple = prevTuples.data() + r * tupleWidth;
+            tuple[0] = prevInstances.patterns[r];
+            for (size_t j = 0; j < prevWidth; ++j) {
+                tuple[1 + j] = row[j]->featureIndex;
+            }
         }
+        std::vector<uint32_t> order;
+        radixSortTuples(prevTuples, tupleWidth, order);
 
-		// Check if the (k-1)-subset exists in previous instances
-        if (validPrevIds.find(subInstanceIds) != validPrevIds.end()) {
-            thread_buffers[thread_id].push_back(instance);
+        std::vector<uint32_t> queryTuples(static_cast<size_t>(queries) * tupleWidth);
+        #pragma omp parallel for
+        for (int64_t q = 0; q < queries; ++q) {
+            const SpatialInstance* const* row = instances.row(queryRows[q]);
+            uint32_t* tuple = queryTuples.data() + q * tupleWidth;
+            tuple[0] = suffixIds[instances.patterns[queryRows[q]]];
+            for (size_t j = 0; j < prevWidth; ++j) {
+                tuple[1 + j] = row[1 + j]->featureIndex;
+            }
         }
+        radixSortTuples(queryTuples, tupleWidth, order);
+
+        // Original row of each sorted query
+        std::vector<uint32_t> sortedRows(static_cast<size_t>(queries));
+        for (int64_t q = 0; q < queries; ++q) {
+            sortedRows[q] = queryRows[order[q]];
+        }
+
+        mergeSortedKeys(prevRows, queries,
+            [&](int64_t p, int64_t q) {
+                const uint32_t* a = prevTuples.data() + p * tupleWidth;
+                const uint32_t* b = queryTuples.data() + q * tupleWidth;
+                for (size_t j = 0; j < tupleWidth; ++j) {
+                    if (a[j] != b[j]) return a[j] < b[j] ? -1 : 1;
+                }
+                return 0;
+            },
+            sortedRows, keep.data());
     }
 
     // ========================================================================
-	// STEP 4: COMBINE RESULTS
+	// STEP 3: COMBINE RESULTS
     // ========================================================================
-    std::vector<ColocationInstance> filteredInstances;
+    // Kept rows are copied in their original order
+    size_t total = static_cast<size_t>(std::count(keep.begin(), keep.end(), 1));
+
+    InstanceTable filteredInstances;
+    filteredInstances.width = width;
+    filteredInstances.cells.reserve(total * width);
+    filteredInstances.patterns.reserve(total);
+    for (int64_t i = 0; i < rows; ++i) {
+        if (!keep[i]) continue;
+        const SpatialInstance* const* row = instances.row(i);
+        filteredInstances.cells.insert(filteredInstances.cells.end(), row, row + width);
+        filteredInstances.patterns.push_back(instances.patterns[i]);
+    }
+
+    return filteredInstances;
+}
+
+
+InstanceTable JoinlessMiner::filterCliqueInstancesByAdjacency(
+    const InstanceTable& instances,
+    const NeighborhoodMgr& neighborhoods,
+    LevelArena& arena
+) {
+    // Each thread records the positions of the instances it keeps
+    int num_threads = omp_get_max_threads();
+    std::vector<std::pmr::vector<size_t>> thread_buffers;
+    thread_buffers.reserve(num_threads);
+    for (int t = 0; t < num_threads; ++t) {
+        thread_buffers.emplace_back(arena.resource(t));
+    }
+
+    // The center is a neighbor of every other instance by construction; the
+    // instance is a clique if the other instances are pairwise neighbors
+    int64_t rows = static_cast<int64_t>(instances.rows());
+    size_t k = instances.width;
+
+    #pragma omp parallel for
+    for (int64_t i = 0; i < rows; ++i) {
+        const SpatialInstance* const* instance = instances.row(i);
+        if (nonCentersAdjacent(neighborhoods, instance, k)) {
+            thread_buffers[omp_get_thread_num()].push_back(static_cast<size_t>(i));
+        }
+    }
+
+    size_t total = 0;
     for (const auto& buffer : thread_buffers) {
-        filteredInstances.insert(filteredInstances.end(), buffer.begin(), buffer.end());
+        total += buffer.size();
+    }
+
+    InstanceTable filteredInstances;
+    filteredInstances.width = instances.width;
+    filteredInstances.cells.reserve(total * instances.width);
+    filteredInstances.patterns.reserve(total);
+    for (const auto& buffer : thread_buffers) {
+        for (size_t idx : buffer) {
+            const SpatialInstance* const* row = instances.row(idx);
+            filteredInstances.cells.insert(filteredInstances.cells.end(), row, row + instances.width);
+            filteredInstances.patterns.push_back(instances.patterns[idx]);
+        }
     }
 
     return filteredInstances;
 }
 
 
-std::vector<Colocation> JoinlessMiner::selectPrevColocations(
-    const std::vector<Colocation>& candidates, 
-    const std::vector<ColocationInstance>& instances, 
-    double minPrev, 
-    const std::map<FeatureType, int>& featureCount) 
+std::vector<Pattern> JoinlessMiner::selectPrevPairs(
+    const std::unordered_map<FeatureType, std::vector<StarNeighborhood>>& starNeighborhoods,
+    const std::vector<Pattern>& candidates,
+    double minPrev)
+{
+    int64_t numFeatures = static_cast<int64_t>(featureTypes.size());
+
+    auto starsByFeature = starsByFeatureCode(starNeighborhoods);
+
+    // Candidate pairs {a, b} flagged at a * numFeatures + b, and centers with any
+    std::vector<char> wanted(numFeatures * numFeatures, 0);
+    std::vector<char> wantedCenter(numFeatures, 0);
+    for (const auto& pair : candidates) {
+        wanted[pair[0] * numFeatures + pair[1]] = 1;
+        wantedCenter[pair[0]] = 1;
+    }
+
+    // Pattern {a, b} only gets instances from the stars of a, so each center
+    // feature is an independent task with its own row of bitmaps
+    std::vector<std::vector<FeatureCode>> prevalentPartners(numFeatures);
+
+    #pragma omp parallel
+    {
+        // Participation of the centers (a) and of the neighbors (b) of every pattern {a, b}
+        std::vector<ParticipationBitmap> centerSlots(numFeatures);
+        std::vector<ParticipationBitmap> neighborSlots(numFeatures);
+
+        #pragma omp for schedule(dynamic)
+        for (int64_t a = 0; a < numFeatures; ++a) {
+            if (!wantedCenter[a]) continue;
+            const char* wantedPartner = wanted.data() + a * numFeatures;
+            for (int64_t b = a + 1; b < numFeatures; ++b) {
+                if (!wantedPartner[b]) continue;
+                centerSlots[b].reset(featureSizes[a], countedSizes[a]);
+                neighborSlots[b].reset(featureSizes[b], countedSizes[b]);
+            }
+
+            // Every neighbor group of a star is one size-2 instance set: the
+            // center and each neighbor of the group participate
+            if (starsByFeature[a] != nullptr) {
+                for (const auto& star : *starsByFeature[a]) {
+                    for (const auto& group : star.groups) {
+                        if (!wantedPartner[group.feature]) continue;
+                        centerSlots[group.feature].set(star.center->featureIndex);
+                        for (uint32_t n = group.begin; n < group.end; ++n) {
+                            neighborSlots[group.feature].set(star.neighbors[n]->featureIndex);
+                        }
+                    }
+                }
+            }
+
+            for (int64_t b = a + 1; b < numFeatures; ++b) {
+                if (!wantedPartner[b]) continue;
+                double centerRatio = (double)centerSlots[b].count / (double)countedSizes[a];
+                double neighborRatio = (double)neighborSlots[b].count / (double)countedSizes[b];
+                if (std::min(centerRatio, neighborRatio) >= minPrev) {
+                    prevalentPartners[a].push_back(static_cast<FeatureCode>(b));
+                }
+            }
+        }
+    }
+
+    // Codes follow the sorted feature names, so (a, b) order is the pattern order
+    std::vector<Pattern> prevalent;
+    for (int64_t a = 0; a < numFeatures; ++a) {
+        for (FeatureCode b : prevalentPartners[a]) {
+            Pattern pair;
+            pair.push_back(static_cast<FeatureCode>(a));
+            pair.push_back(b);
+            prevalent.push_back(pair);
+        }
+    }
+    return prevalent;
+}
+
+
+std::vector<Pattern> JoinlessMiner::selectPrevColocations(
+    const PatternRegistry& registry,
+    const InstanceTable& instances, 
+    double minPrev) 
 {
-    std::vector<Colocation> coarsePrevalent;
+    std::vector<Pattern> prevalent;
+    size_t k = registry.patternSize();
+
+    size_t numBitmaps = registry.size() * k;
 
     // ========================================================================
-    // STEP 1: Data structure for aggregation
+    // STEP 1: Participant thresholds
     // ========================================================================
-    // Key: Candidate (Pattern)
-    // Value: Map<FeatureType, Set<InstanceID>> - count unique instances for each feature
-    std::map<Colocation, std::map<FeatureType, std::set<std::string>>> candidateStats;
+    // One bitmap per (pattern, slot) at index patternId * k + slot, over the
+    // instances of the slot's feature, with the participant count it needs
+    std::vector<size_t> need(numBitmaps);
+    for (PatternId id = 0; id < registry.size(); ++id) {
+        const FeatureCode* codes = registry.patternCodes(id);
+        for (size_t slot = 0; slot < k; ++slot) {
+            need[id * k + slot] = participationThreshold(minPrev, countedSizes[codes[slot]]);
+        }
+    }
 
-    // Initialize stats map for all candidates (ensures every candidate has an entry even without instances)
-    // This step costs O(C), very fast compared to O(C*I)
-    for (const auto& cand : candidates) {
-        candidateStats[cand]; // Create empty entry
+    // ========================================================================
+    // STEP 2: Parallel pass through instances into thread-local bitmaps
+    // ========================================================================
+    // Each thread takes a contiguous block of rows, which covers only a few
+    // center features and so few of the candidates. Its state is keyed
+    // sparsely: a block of k bitmaps is taken from the thread's pool on the
+    // first row of each pattern it meets. A pattern whose every feature
+    // reaches its threshold within one thread is settled as prevalent and its
+    // remaining rows there are skipped.
+    // The team may be smaller than requested (OMP_DYNAMIC, thread limits), so
+    // only the entries of the threads that actually ran are used afterwards
+    struct ThreadParticipation {
+        std::unordered_map<PatternId, size_t> blockOf;  ///< Pattern ID -> block in touched
+        std::vector<PatternId> touched;                 ///< Patterns met, in block order
+        std::vector<ParticipationBitmap> slots;         ///< k bitmaps per touched pattern
+        std::vector<char> settled;                      ///< Per touched pattern
+    };
+
+    int num_threads = omp_get_max_threads();
+    std::vector<ThreadParticipation> threadParticipation(num_threads);
+    int64_t rows = static_cast<int64_t>(instances.rows());
+
+    #pragma omp parallel
+    {
+        #pragma omp single
+        num_threads = omp_get_num_threads();
+
+        ThreadParticipation& local = threadParticipation[omp_get_thread_num()];
+
+        dispatchPatternSize(k, [&](auto fixed) {
+            const size_t width = decltype(fixed)::value ? decltype(fixed)::value : k;
+
+            // Rows of one pattern tend to be adjacent, so the last block is cached
+            PatternId lastId = 0;
+            size_t block = SIZE_MAX;
+
+            #pragma omp for schedule(static)
+            for (int64_t r = 0; r < rows; ++r) {
+                PatternId id = instances.patterns[r];
+                if (block == SIZE_MAX || id != lastId) {
+                    auto inserted = local.blockOf.emplace(id, local.touched.size());
+                    block = inserted.first->second;
+                    lastId = id;
+                    if (inserted.second) {
+                        local.touched.push_back(id);
+                        local.settled.push_back(0);
+                        local.slots.resize(local.touched.size() * width);
+                        const FeatureCode* codes = registry.patternCodes(id);
+                        for (size_t slot = 0; slot < width; ++slot) {
+                            local.slots[block * width + slot].reset(
+                                featureSizes[codes[slot]], countedSizes[codes[slot]]);
+                        }
+                    }
+                }
+                if (local.settled[block]) continue;
+
+                ParticipationBitmap* slots = local.slots.data() + block * width;
+                const SpatialInstance* const* instance = instances.row(r);
+                for (size_t slot = 0; slot < width; ++slot) {
+                    slots[slot].set(instance[slot]->featureIndex);
+                }
+                local.settled[block] = thresholdsReached(slots, need.data() + id * width, width);
+            }
+        });
     }
 
     // ========================================================================
-    // STEP 2: Single pass through instances
+    // STEP 3: Group the touched blocks by pattern
     // ========================================================================
-    // Time complexity: O(I * K * log(K)) where K is pattern length (typically very small)
-    for (const ColocationInstance& instance : instances) {
-        // 2a. Extract pattern from instance
-        // Example: Instance has A1, B1 -> Pattern is {A, B}
-        Colocation patternKey;
-        for (const auto& instPtr : instance) {
-            patternKey.push_back(instPtr->type);
+    // (thread, block) owners of every pattern, in CSR form over pattern IDs;
+    // patterns no thread met have no owners
+    std::vector<size_t> ownerStart(registry.size() + 1, 0);
+    for (int t = 0; t < num_threads; ++t) {
+        for (PatternId id : threadParticipation[t].touched) {
+            ++ownerStart[id + 1];
         }
-        // Ensure patternKey is sorted to match key in map (if candidate is already sorted)
-        // std::sort(patternKey.begin(), patternKey.end()); 
-
-        // 2b. Check if this pattern is in the candidates of interest
-        auto it = candidateStats.find(patternKey);
-        if (it != candidateStats.end()) {
-            // 2c. Update participating instances statistics
-            // it->second is map<Feature, Set<ID>>
-            for (const auto& instPtr : instance) {
-                it->second[instPtr->type].insert(instPtr->id);
+    }
+    for (size_t id = 0; id < registry.size(); ++id) {
+        ownerStart[id + 1] += ownerStart[id];
+    }
+    std::vector<std::pair<int, size_t>> owners(ownerStart.back());
+    {
+        std::vector<size_t> fill(ownerStart.begin(), ownerStart.end() - 1);
+        for (int t = 0; t < num_threads; ++t) {
+            const std::vector<PatternId>& touched = threadParticipation[t].touched;
+            for (size_t block = 0; block < touched.size(); ++block) {
+                owners[fill[touched[block]]++] = {t, block};
             }
         }
     }
 
     // ========================================================================
-    // STEP 3: Calculate ratios and filter (iterate through candidates)
+    // STEP 4: Merge each pattern's blocks and check thresholds in parallel
     // ========================================================================
-    // Time complexity: O(C * K)
-    for (const auto& item : candidateStats) {
-        const Colocation& candidate = item.first;
-        const auto& participatingMap = item.second; // Map<Feature, Set<ID>>
-
-        double min_participation_ratio = 1.0;
-        bool possible = true;
-        
-        // If no instances participate -> participatingMap may be missing features or have empty sets
-        
-        for (const auto& feature : candidate) {
-            // Get total global instance count for this feature
-            auto totalIt = featureCount.find(feature);
-            if (totalIt == featureCount.end() || totalIt->second == 0) {
-                possible = false;
-                break;
+    // Patterns own disjoint blocks, so each merges into its first owner's
+    // bitmaps without synchronization. IDs follow candidate order, so
+    // collecting the flags in ID order keeps results sorted
+    int64_t numPatterns = static_cast<int64_t>(registry.size());
+    std::vector<char> isPrevalent(registry.size(), 0);
+
+    #pragma omp parallel for schedule(dynamic, 64)
+    for (int64_t id = 0; id < numPatterns; ++id) {
+        const size_t* patternNeed = need.data() + id * k;
+        size_t first = ownerStart[id], last = ownerStart[id + 1];
+
+        if (first == last) {
+            // No instances: prevalent only if no participant is needed
+            isPrevalent[id] = std::all_of(patternNeed, patternNeed + k, [](size_t n) { return n == 0; });
+            continue;
+        }
+
+        bool settled = false;
+        for (size_t o = first; o < last && !settled; ++o) {
+            settled = threadParticipation[owners[o].first].settled[owners[o].second] != 0;
+        }
+        if (settled) {
+            isPrevalent[id] = 1;
+            continue;
+        }
+
+        // Participation index reaches minPrev iff every count reaches its threshold
+        ParticipationBitmap* into =
+            threadParticipation[owners[first].first].slots.data() + owners[first].second * k;
+        for (size_t o = first + 1; o < last; ++o) {
+            ParticipationBitmap* from =
+                threadParticipation[owners[o].first].slots.data() + owners[o].second * k;
+            for (size_t slot = 0; slot < k; ++slot) {
+                into[slot].merge(from[slot]);
+                ParticipationBitmap().words.swap(from[slot].words);
             }
-            double totalFeatureCount = (double)(totalIt->second);
+        }
+        isPrevalent[id] = thresholdsReached(into, patternNeed, k);
+    }
 
-            // Get count of instances participating in pattern
-            int participatedCount = 0;
-            auto partIt = participatingMap.find(feature);
-            if (partIt != participatingMap.end()) {
-                participatedCount = partIt->second.size();
+    for (PatternId id = 0; id < registry.size(); ++id) {
+        if (isPrevalent[id]) {
+            prevalent.push_back(registry.pattern(id));
+        }
+    }
+
+    return prevalent;
+}
+
+
+std::vector<Pattern> JoinlessMiner::selectCoarsePrevColocations(
+    const std::vector<Pattern>& candidates,
+    const std::unordered_map<FeatureType, std::vector<StarNeighborhood>>& starNeighborhoods,
+    double minPrev)
+{
+    std::vector<Pattern> coarsePrevalent;
+    auto starsByFeature = starsByFeatureCode(starNeighborhoods);
+
+    // Candidates are independent, so each is one task; flags keep the input order
+    int64_t numCandidates = static_cast<int64_t>(candidates.size());
+    std::vector<char> isPrevalent(candidates.size(), 0);
+
+    #pragma omp parallel
+    {
+        // One participation bitmap and threshold per pattern slot, reused from
+        // candidate to candidate within a thread
+        std::vector<ParticipationBitmap> slots;
+        std::vector<size_t> need;
+        StarEnumerator enumerator;
+
+        #pragma omp for schedule(dynamic)
+        for (int64_t c = 0; c < numCandidates; ++c) {
+            const Pattern& codes = candidates[c];
+            if (starsByFeature[codes[0]] == nullptr) continue;
+
+            FeatureMask required;
+            if (!requiredFeatureMask(codes, required)) {
+                required = FeatureMask();
             }
+            slots.resize(codes.size());
+            need.resize(codes.size());
+            for (size_t slot = 0; slot < codes.size(); ++slot) {
+                slots[slot].reset(featureSizes[codes[slot]], countedSizes[codes[slot]]);
+                need[slot] = participationThreshold(minPrev, countedSizes[codes[slot]]);
+            }
+
+            // A center participates if its star holds every other feature of the
+            // candidate, and then so does each of its neighbors of those features.
+            // The scan stops as soon as the outcome is known either way.
+            const auto& stars = *starsByFeature[codes[0]];
+            for (size_t s = 0; s < stars.size(); ++s) {
+                // Infeasible: even if every unscanned center took part, too few would
+                if (slots[0].count + (stars.size() - s) < need[0]) break;
+
+                const auto& star = stars[s];
+                if (!star.presence.contains(required)) continue;
+                if (enumerator.bind(star, codes)) {
+                    enumerator.markParticipants(slots.data());
 
-            double ratio = (double)participatedCount / totalFeatureCount;
-            if (ratio < min_participation_ratio) {
-                min_participation_ratio = ratio;
+                    // Prevalent: every feature already has enough participants
+                    if (thresholdsReached(slots.data(), need.data(), need.size())) break;
+                }
             }
+
+            // Participation index reaches minPrev iff every count reaches its threshold
+            isPrevalent[c] = thresholdsReached(slots.data(), need.data(), need.size());
         }
+    }
 
-        if (possible && min_participation_ratio >= minPrev) {
-            coarsePrevalent.push_back(candidate);
+    for (int64_t c = 0; c < numCandidates; ++c) {
+        if (isPrevalent[c]) {
+            coarsePrevalent.push_back(candidates[c]);
         }
     }
 
     return coarsePrevalent;
-}
\ No newline at end of file
+}
+
+
+std::vector<Pattern> JoinlessMiner::selectPrevColocationsOutOfCore(
+    const PatternRegistry& registry,
+    const PatternRegistry& prevRegistry,
+    const NeighborhoodMgr& neighborhoods,
+    const ExternalSorter* prevCliques,
+    ExternalSorter& cliques,
+    double minPrev)
+{
+    size_t k = registry.patternSize();
+    size_t numPatterns = registry.size();
+
+    std::vector<ParticipationBitmap> slots(numPatterns * k);
+    for (PatternId id = 0; id < numPatterns; ++id) {
+        for (size_t slot = 0; slot < k; ++slot) {
+            slots[id * k + slot].reset(featureSizes[registry.pattern(id)[slot]], countedSizes[registry.pattern(id)[slot]]);
+        }
+    }
+
+    // A clique tuple is its pattern ID followed by the feature index of each member
+    std::vector<uint32_t> clique(k + 1);
+    auto acceptClique = [&](PatternId id, const uint32_t* members) {
+        clique[0] = id;
+        std::copy(members, members + k, clique.begin() + 1);
+        cliques.push(clique.data());
+        for (size_t slot = 0; slot < k; ++slot) {
+            slots[id * k + slot].set(members[slot]);
+        }
+    };
+
+    // ========================================================================
+    // STEP 1: STREAM STAR INSTANCES
+    // ========================================================================
+    // Without previous cliques (at k=3, or when constrained) the edges outside the
+    // star are checked in the neighbor graph at once. Otherwise each star instance
+    // becomes a query tuple (suffix ID, non-center members, pattern ID, center)
+    // sorted into spilling runs.
+    std::vector<PatternId> suffixIds(numPatterns, PatternRegistry::kNone);
+    if (prevCliques != nullptr) {
+        for (PatternId id = 0; id < numPatterns; ++id) {
+            suffixIds[id] = prevRegistry.find(registry.pattern(id).without(0));
+        }
+    }
+
+    ExternalSorter starRuns(k + 2, memoryBudget / 4, spillDirectory);
+    std::vector<uint32_t> tuple(k + 2);
+    std::vector<uint32_t> members(k);
+    std::vector<const SpatialInstance*> rows;
+    StarEnumerator enumerator;
+
+    auto starsByFeature = starsByFeatureCode(neighborhoods.getAllStarNeighborhoods());
+    for (FeatureCode center = 0; center < starsByFeature.size(); ++center) {
+        if (starsByFeature[center] == nullptr) continue;
+
+        std::vector<PatternId> relevantIds;
+        std::vector<FeatureMask> requiredMasks;
+        for (PatternId id = 0; id < numPatterns; ++id) {
+            if (registry.pattern(id)[0] != center) continue;
+            if (prevCliques != nullptr && suffixIds[id] == PatternRegistry::kNone) continue;
+            relevantIds.push_back(id);
+            requiredMasks.emplace_back();
+            if (!requiredFeatureMask(registry.pattern(id), requiredMasks.back())) {
+                requiredMasks.back() = FeatureMask();
+            }
+        }
+        if (relevantIds.empty()) continue;
+
+        for (const auto& star : *starsByFeature[center]) {
+            for (size_t c = 0; c < relevantIds.size(); ++c) {
+                PatternId id = relevantIds[c];
+                if (!star.presence.contains(requiredMasks[c])) continue;
+                if (!enumerator.bind(star, registry.pattern(id))) continue;
+
+                rows.clear();
+                size_t count = enumerator.emit(rows);
+                for (size_t r = 0; r < count; ++r) {
+                    const SpatialInstance* const* row = rows.data() + r * k;
+                    if (prevCliques == nullptr) {
+                        if (!nonCentersAdjacent(neighborhoods, row, k)) continue;
+                        for (size_t slot = 0; slot < k; ++slot) {
+                            members[slot] = row[slot]->featureIndex;
+                        }
+                        acceptClique(id, members.data());
+                    } else {
+                        tuple[0] = suffixIds[id];
+                        for (size_t slot = 1; slot < k; ++slot) {
+                            tuple[slot] = row[slot]->featureIndex;
+                        }
+                        tuple[k] = id;
+                        tuple[k + 1] = row[0]->featureIndex;
+                        starRuns.push(tuple.data());
+                    }
+                }
+            }
+        }
+    }
+
+    // ========================================================================
+    // STEP 2: EXTERNAL MERGE AGAINST THE PREVIOUS CLIQUE TUPLES
+    // ========================================================================
+    // Both streams are sorted, and a query's first k words have the layout of a
+    // previous clique tuple: equal words mean the star instance is a clique
+    if (prevCliques != nullptr) {
+        starRuns.finish();
+        ExternalSorter::Cursor queries = starRuns.cursor();
+        ExternalSorter::Cursor known = prevCliques->cursor();
+        while (queries.valid() && known.valid()) {
+            const uint32_t* q = queries.tuple();
+            const uint32_t* p = known.tuple();
+            auto mismatch = std::mismatch(q, q + k, p);
+            if (mismatch.first == q + k) {
+                members[0] = q[k + 1];
+                std::copy(q + 1, q + k, members.begin() + 1);
+                acceptClique(q[k], members.data());
+                queries.next();  // Other centers may share the same suffix instance
+            } else if (*mismatch.first < *mismatch.second) {
+                queries.next();
+            } else {
+                known.next();
+            }
+        }
+    }
+    cliques.finish();
+
+    // ========================================================================
+    // STEP 3: SELECT PREVALENT PATTERNS
+    // ========================================================================
+    std::vector<Pattern> prevalent;
+    for (PatternId id = 0; id < numPatterns; ++id) {
+        bool isPrevalent = true;
+        for (size_t slot = 0; slot < k && isPrevalent; ++slot) {
+            size_t need = participationThreshold(minPrev, countedSizes[registry.pattern(id)[slot]]);
+            isPrevalent = slots[id * k + slot].count >= need;
+        }
+        if (isPrevalent) {
+            prevalent.push_back(registry.pattern(id));
+        }
+    }
+    return prevalent;
+}
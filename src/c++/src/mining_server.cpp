@@ -0,0 +1,598 @@
+/**
+ * @file mining_server.cpp
+ * @brief Implementation of the resident mining service
+ */
+
+#include "mining_server.h"
+#include "data_loader.h"
+#include "miner.h"
+#include "region.h"
+#include "region_view.h"
+#include "spatial_index.h"
+#include "thread_pool.h"
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <numeric>
+#include <sstream>
+#include <stdexcept>
+#include <omp.h>
+
+#ifndef _WIN32
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+// ============================================================================
+// Minimal JSON reading and writing for the request protocol
+// ============================================================================
+
+/**
+ * Parsed JSON value; objects keep their members by key
+ */
+struct JsonValue {
+    enum Kind { Null, Bool, Number, String, Array, Object };
+    Kind kind = Null;
+    bool boolean = false;
+    double number = 0.0;
+    std::string text;
+    std::vector<JsonValue> items;
+    std::map<std::string, JsonValue> members;
+
+    const JsonValue* find(const std::string& key) const {
+        auto it = members.find(key);
+        return it == members.end() ? nullptr : &it->second;
+    }
+};
+
+class JsonParser {
+private:
+    // Requests are objects of flat arrays; the limit keeps recursion off the stack's edge
+    static constexpr size_t kMaxDepth = 64;
+
+    const std::string& input;
+    size_t pos = 0;
+    size_t depth = 0;  ///< Objects and arrays currently open
+
+    [[noreturn]] void fail(const std::string& what) const {
+        throw std::runtime_error("Invalid JSON at offset " + std::to_string(pos) + ": " + what);
+    }
+
+    void skipSpace() {
+        while (pos < input.size() && std::isspace(static_cast<unsigned char>(input[pos]))) ++pos;
+    }
+
+    bool consume(char c) {
+        skipSpace();
+        if (pos < input.size() && input[pos] == c) {
+            ++pos;
+            return true;
+        }
+        return false;
+    }
+
+    void expect(char c) {
+        if (!consume(c)) fail(std::string("expected '") + c + "'");
+    }
+
+    std::string parseString() {
+        expect('"');
+        std::string out;
+        while (pos < input.size() && input[pos] != '"') {
+            char c = input[pos++];
+            if (c != '\\') {
+                out += c;
+                continue;
+            }
+            if (pos >= input.size()) break;
+            char e = input[pos++];
+            switch (e) {
+                case 'n': out += '\n'; break;
+                case 't': out += '\t'; break;
+                case 'r': out += '\r'; break;
+                case 'b': out += '\b'; break;
+                case 'f': out += '\f'; break;
+                case 'u': {
+                    if (pos + 4 > input.size()) fail("truncated escape");
+                    unsigned code = static_cast<unsigned>(std::stoul(input.substr(pos, 4), nullptr, 16));
+                    pos += 4;
+                    // Basic multilingual plane only, encoded as UTF-8
+                    if (code < 0x80) {
+                        out += static_cast<char>(code);
+                    } else if (code < 0x800) {
+                        out += static_cast<char>(0xC0 | (code >> 6));
+                        out += static_cast<char>(0x80 | (code & 0x3F));
+                    } else {
+                        out += static_cast<char>(0xE0 | (code >> 12));
+                        out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+                        out += static_cast<char>(0x80 | (code & 0x3F));
+                    }
+                    break;
+                }
+                default: out += e; break;
+            }
+        }
+        if (pos >= input.size()) fail("unterminated string");
+        ++pos;
+        return out;
+    }
+
+    JsonValue parseValue() {
+        skipSpace();
+        if (pos >= input.size()) fail("unexpected end");
+
+        JsonValue value;
+        char c = input[pos];
+        if (c == '{' || c == '[') {
+            if (++depth > kMaxDepth) fail("nesting too deep");
+        }
+        if (c == '{') {
+            ++pos;
+            value.kind = JsonValue::Object;
+            if (!consume('}')) {
+                do {
+                    skipSpace();
+                    std::string key = parseString();
+                    expect(':');
+                    value.members[key] = parseValue();
+                } while (consume(','));
+                expect('}');
+            }
+            --depth;
+        } else if (c == '[') {
+            ++pos;
+            value.kind = JsonValue::Array;
+            if (!consume(']')) {
+                do {
+                    value.items.push_back(parseValue());
+                } while (consume(','));
+                expect(']');
+            }
+            --depth;
+        } else if (c == '"') {
+            value.kind = JsonValue::String;
+            value.text = parseString();
+        } else if (input.compare(pos, 4, "true") == 0 || input.compare(pos, 5, "false") == 0) {
+            value.kind = JsonValue::Bool;
+            value.boolean = (c == 't');
+            pos += value.boolean ? 4 : 5;
+        } else if (input.compare(pos, 4, "null") == 0) {
+            pos += 4;
+        } else {
+            // strtod also reads nan, inf and hexadecimal, which JSON does not have
+            if (c != '-' && !std::isdigit(static_cast<unsigned char>(c))) fail("unexpected character");
+            size_t span = input.find_first_not_of("0123456789+-.eE", pos) - pos;
+            const char* begin = input.c_str() + pos;
+            char* end = nullptr;
+            value.kind = JsonValue::Number;
+            value.number = std::strtod(begin, &end);
+            if (end == begin || static_cast<size_t>(end - begin) != std::min(span, input.size() - pos)) {
+                fail("invalid number");
+            }
+            pos += static_cast<size_t>(end - begin);
+        }
+        return value;
+    }
+
+public:
+    explicit JsonParser(const std::string& text) : input(text) {}
+
+    JsonValue parse() {
+        JsonValue value = parseValue();
+        skipSpace();
+        if (pos != input.size()) fail("trailing characters");
+        return value;
+    }
+};
+
+std::string quote(const std::string& text) {
+    std::string out = "\"";
+    for (char c : text) {
+        switch (c) {
+            case '"': out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\t': out += "\\t"; break;
+            case '\r': out += "\\r"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    char escaped[8];
+                    std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+                    out += escaped;
+                } else {
+                    out += c;
+                }
+        }
+    }
+    return out + "\"";
+}
+
+double numberField(const JsonValue& request, const std::string& key, double fallback) {
+    const JsonValue* field = request.find(key);
+    if (field == nullptr || field->kind == JsonValue::Null) return fallback;
+    if (field->kind != JsonValue::Number) {
+        throw std::runtime_error("Field '" + key + "' must be a number");
+    }
+    if (!std::isfinite(field->number)) {
+        throw std::runtime_error("Field '" + key + "' must be finite");
+    }
+    return field->number;
+}
+
+std::vector<FeatureType> featureList(const JsonValue& request, const std::string& key,
+                                     const std::vector<FeatureType>& fallback) {
+    const JsonValue* field = request.find(key);
+    if (field == nullptr || field->kind == JsonValue::Null) return fallback;
+    if (field->kind != JsonValue::Array) {
+        throw std::runtime_error("Field '" + key + "' must be an array");
+    }
+    std::vector<FeatureType> features;
+    for (const auto& item : field->items) {
+        if (item.kind != JsonValue::String) {
+            throw std::runtime_error("Field '" + key + "' must hold strings");
+        }
+        features.push_back(item.text);
+    }
+    return features;
+}
+
+} // namespace
+
+
+MiningServer::MiningServer(const AppConfig& settings)
+    : config(settings), order(parseSpatialOrder(settings.spatialOrder)) {}
+
+
+std::shared_ptr<MiningServer::Dataset> MiningServer::dataset(const std::string& path) {
+    std::shared_future<std::shared_ptr<Dataset>> pending;
+    std::promise<std::shared_ptr<Dataset>> loader;
+    bool load = false;
+    {
+        std::lock_guard<std::mutex> lock(datasetsMutex);
+        auto it = datasets.find(path);
+        if (it == datasets.end()) {
+            pending = loader.get_future().share();
+            datasets.emplace(path, pending);
+            load = true;
+        } else {
+            pending = it->second;
+        }
+    }
+
+    // The first request for a path loads it; later ones wait on the same future
+    if (load) {
+        try {
+            auto data = std::make_shared<Dataset>();
+            data->instances = DataLoader::load_csv(path, 1.0, order);
+            if (data->instances.empty()) {
+                throw std::runtime_error("Dataset " + path + " has no instances");
+            }
+            loader.set_value(data);
+        } catch (...) {
+            // A failed load is not cached, so the file can be fixed and retried
+            loader.set_exception(std::current_exception());
+            std::lock_guard<std::mutex> lock(datasetsMutex);
+            datasets.erase(path);
+        }
+    }
+    return pending.get();
+}
+
+
+std::shared_ptr<MiningServer::Graph> MiningServer::neighborhoods(Dataset& data, double distance, bool& cached) {
+    std::shared_future<std::shared_ptr<Graph>> pending;
+    std::promise<std::shared_ptr<Graph>> builder;
+    {
+        std::lock_guard<std::mutex> lock(data.mutex);
+        auto it = data.graphs.find(distance);
+        cached = (it != data.graphs.end());
+        if (cached) {
+            pending = it->second;
+        } else {
+            pending = builder.get_future().share();
+            data.graphs.emplace(distance, pending);
+        }
+    }
+
+    if (!cached) {
+        try {
+            auto graph = std::make_shared<Graph>(distance);
+            graph->stars.buildFromIndex(data.instances, graph->index);
+            builder.set_value(graph);
+        } catch (...) {
+            builder.set_exception(std::current_exception());
+            std::lock_guard<std::mutex> lock(data.mutex);
+            data.graphs.erase(distance);
+        }
+    }
+    return pending.get();
+}
+
+
+std::string MiningServer::handleRequest(const std::string& line) {
+    auto start = std::chrono::high_resolution_clock::now();
+    try {
+        JsonValue request = JsonParser(line).parse();
+        if (request.kind != JsonValue::Object) {
+            throw std::runtime_error("Request must be a JSON object");
+        }
+
+        std::string path = config.datasetPath;
+        if (const JsonValue* field = request.find("dataset")) {
+            if (field->kind != JsonValue::String) throw std::runtime_error("Field 'dataset' must be a string");
+            path = field->text;
+        }
+        double distance = numberField(request, "distance", config.neighborDistance);
+        double minPrev = numberField(request, "min_prevalence", config.minPrev);
+        double topK = numberField(request, "top_k", 0.0);
+        if (distance <= 0.0) throw std::runtime_error("Field 'distance' must be positive");
+        if (minPrev < 0.0 || minPrev > 1.0) throw std::runtime_error("Field 'min_prevalence' must be in [0, 1]");
+        if (topK < 0.0 || topK != std::floor(topK)) {
+            throw std::runtime_error("Field 'top_k' must be a non-negative integer");
+        }
+
+        std::vector<FeatureType> required = featureList(request, "features", config.includeFeatures);
+        std::vector<FeatureType> excluded = featureList(request, "exclude", config.excludeFeatures);
+        std::string regionSpec = config.region;
+        if (const JsonValue* field = request.find("region")) {
+            if (field->kind != JsonValue::String) throw std::runtime_error("Field 'region' must be a string");
+            regionSpec = field->text;
+        }
+
+        std::shared_ptr<Dataset> data = dataset(path);
+        bool cached = false;
+        std::shared_ptr<Graph> graph = neighborhoods(*data, distance, cached);
+
+        // A region is cut from the resident index and stars of the whole dataset
+        const std::vector<SpatialInstance>* instances = &data->instances;
+        NeighborhoodMgr* stars = &graph->stars;
+        std::unique_ptr<RegionView> region;
+        if (!regionSpec.empty()) {
+            region = std::make_unique<RegionView>(Region::parse(regionSpec), data->instances, distance,
+                                                  graph->index, graph->stars);
+            instances = &region->getInstances();
+            stars = &region->getNeighborhoods();
+        }
+
+        JoinlessMiner miner;
+        miner.setMemoryBudget(static_cast<size_t>(config.maxMemoryMb * 1024 * 1024), config.spillDir);
+        miner.setFeatureConstraints(required, excluded);
+        if (region) {
+            miner.setCoreSizes(region->getCoreSizes());
+        }
+        std::vector<Colocation> patterns = (config.miningStrategy == "depthfirst")
+            ? miner.mineColocationsDepthFirst(minPrev, stars, *instances)
+            : miner.mineColocations(minPrev, stars, *instances);
+
+        // Rank by participation index, highest first (mining order breaks ties)
+        std::vector<double> indices;
+        std::vector<size_t> ranking(patterns.size());
+        std::iota(ranking.begin(), ranking.end(), 0);
+        if (topK > 0.0) {
+            indices = miner.participationIndices(patterns, stars, *instances);
+            std::stable_sort(ranking.begin(), ranking.end(), [&](size_t a, size_t b) {
+                return indices[a] > indices[b];
+            });
+            // Clamped before converting: a huge top_k does not fit size_t
+            if (topK < static_cast<double>(ranking.size())) {
+                ranking.resize(static_cast<size_t>(topK));
+            }
+        }
+
+        std::ostringstream reply;
+        reply << "{\"status\": \"ok\", \"patterns\": [";
+        for (size_t r = 0; r < ranking.size(); ++r) {
+            const Colocation& col = patterns[ranking[r]];
+            reply << (r > 0 ? ", " : "") << "{\"features\": [";
+            for (size_t f = 0; f < col.size(); ++f) {
+                reply << (f > 0 ? ", " : "") << quote(col[f]);
+            }
+            reply << "]";
+            if (!indices.empty()) {
+                reply << ", \"participation_index\": " << indices[ranking[r]];
+            }
+            reply << "}";
+        }
+        double elapsed = std::chrono::duration<double, std::milli>(
+            std::chrono::high_resolution_clock::now() - start).count();
+        reply << "]";
+        if (region) {
+            reply << ", \"region_instances\": " << region->coreSize();
+        }
+        reply << ", \"graph_cached\": " << (cached ? "true" : "false")
+              << ", \"elapsed_ms\": " << elapsed << "}";
+        return reply.str();
+    } catch (const std::exception& e) {
+        return "{\"status\": \"error\", \"message\": " + quote(e.what()) + "}";
+    }
+}
+
+
+#ifndef _WIN32
+
+bool MiningServer::sendAll(int fd, const std::string& data) {
+    for (size_t sent = 0; sent < data.size();) {
+        ssize_t written = ::send(fd, data.data() + sent, data.size() - sent, 0);
+        if (written < 0 && errno == EINTR) continue;
+        if (written <= 0) return false;
+        sent += static_cast<size_t>(written);
+    }
+    return true;
+}
+
+
+void MiningServer::run() {
+    // Clients that hang up early must not kill the server
+    std::signal(SIGPIPE, SIG_IGN);
+
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (config.serverSocket.size() >= sizeof(address.sun_path)) {
+        throw std::runtime_error("Socket path too long: " + config.serverSocket);
+    }
+    std::copy(config.serverSocket.begin(), config.serverSocket.end(), address.sun_path);
+
+    int listener = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listener < 0) {
+        throw std::runtime_error("Cannot create server socket");
+    }
+    ::unlink(config.serverSocket.c_str());  // Left over by a previous server
+    if (::bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+        ::listen(listener, 64) != 0) {
+        ::close(listener);
+        throw std::runtime_error("Cannot listen on " + config.serverSocket);
+    }
+
+    // Workers report each answered request on this pipe: (fd, 1 if the reply was sent)
+    int done[2];
+    if (::pipe(done) != 0) {
+        ::close(listener);
+        throw std::runtime_error("Cannot create the server wake-up pipe");
+    }
+
+    // Warm the cache with the configured dataset and distance
+    bool cached = false;
+    neighborhoods(*dataset(config.datasetPath), config.neighborDistance, cached);
+    std::cout << "Serving on " << config.serverSocket << std::endl;
+
+    // Concurrent queries split the OpenMP threads between them
+    size_t poolSize = static_cast<size_t>(std::max(1, config.serverThreads));
+    int queryThreads = std::max(1, omp_get_max_threads() / static_cast<int>(poolSize));
+    ThreadPool pool(poolSize);
+
+    // Connections are owned by this loop; a worker only holds one while it
+    // answers one of its requests, so idle clients never tie up the pool.
+    // A busy connection is not polled, which keeps its requests in order
+    struct Connection {
+        std::string pending;  ///< Received bytes not yet part of a dispatched request
+        bool busy = false;    ///< A worker is answering one of its requests
+    };
+    std::map<int, Connection> connections;
+    auto acceptResume = std::chrono::steady_clock::time_point();
+    bool acceptFailing = false;  // Warned about the current run of failed accepts
+
+    auto closeConnection = [&](int fd) {
+        ::close(fd);
+        connections.erase(fd);
+    };
+
+    // Hand the connection's next complete request to the pool, if any
+    auto dispatch = [&](int fd, Connection& connection) {
+        size_t newline;
+        while ((newline = connection.pending.find('\n')) != std::string::npos) {
+            std::string line = connection.pending.substr(0, newline);
+            connection.pending.erase(0, newline + 1);
+            if (line.find_first_not_of(" \t\r") == std::string::npos) continue;
+
+            connection.busy = true;
+            int doneFd = done[1];
+            pool.submit([this, fd, doneFd, queryThreads, line = std::move(line)] {
+                omp_set_num_threads(queryThreads);
+                int report[2] = {fd, sendAll(fd, handleRequest(line) + "\n") ? 1 : 0};
+                while (::write(doneFd, report, sizeof(report)) < 0 && errno == EINTR) {}
+            });
+            return true;
+        }
+        return false;
+    };
+
+    std::vector<pollfd> polled;
+    for (;;) {
+        polled.clear();
+        polled.push_back({done[0], POLLIN, 0});
+        bool accepting = std::chrono::steady_clock::now() >= acceptResume;
+        if (accepting) {
+            polled.push_back({listener, POLLIN, 0});
+        }
+        for (const auto& entry : connections) {
+            if (!entry.second.busy) {
+                polled.push_back({entry.first, POLLIN, 0});
+            }
+        }
+
+        if (::poll(polled.data(), polled.size(), accepting ? -1 : kAcceptBackoffMs) < 0) {
+            if (errno == EINTR) continue;
+            throw std::runtime_error("poll failed on " + config.serverSocket);
+        }
+
+        for (const pollfd& entry : polled) {
+            if (entry.revents == 0) continue;
+
+            if (entry.fd == done[0]) {
+                // Requests answered: resume reading those connections
+                int report[2];
+                if (::read(done[0], report, sizeof(report)) != static_cast<ssize_t>(sizeof(report))) continue;
+                auto it = connections.find(report[0]);
+                if (it == connections.end()) continue;
+                it->second.busy = false;
+                if (!report[1]) {
+                    closeConnection(report[0]);
+                } else {
+                    dispatch(it->first, it->second);
+                }
+            } else if (entry.fd == listener) {
+                int client = ::accept(listener, nullptr, nullptr);
+                if (client >= 0) {
+                    connections[client];
+                    acceptFailing = false;
+                } else if (errno == EMFILE || errno == ENFILE || errno == ENOBUFS || errno == ENOMEM) {
+                    // Out of descriptors or memory: stop accepting for a while
+                    // instead of spinning on the pending connection
+                    if (!acceptFailing) {
+                        std::cerr << "Warning: cannot accept connections (" << std::strerror(errno)
+                                  << "); retrying every " << kAcceptBackoffMs << " ms\n";
+                        acceptFailing = true;
+                    }
+                    acceptResume = std::chrono::steady_clock::now() +
+                                   std::chrono::milliseconds(kAcceptBackoffMs);
+                } else if (errno != EINTR && errno != EAGAIN && errno != ECONNABORTED) {
+                    throw std::runtime_error(std::string("accept failed: ") + std::strerror(errno));
+                }
+            } else {
+                auto it = connections.find(entry.fd);
+                if (it == connections.end() || it->second.busy) continue;
+
+                char buffer[4096];
+                ssize_t n = ::recv(entry.fd, buffer, sizeof(buffer), 0);
+                if (n < 0 && errno == EINTR) continue;
+                if (n <= 0) {
+                    closeConnection(entry.fd);
+                    continue;
+                }
+                Connection& connection = it->second;
+                connection.pending.append(buffer, static_cast<size_t>(n));
+                if (dispatch(entry.fd, connection)) continue;
+
+                // No newline within the limit: the stream cannot be resynchronized
+                if (connection.pending.size() > kMaxRequestBytes) {
+                    sendAll(entry.fd, "{\"status\": \"error\", \"message\": \"request exceeds " +
+                                      std::to_string(kMaxRequestBytes) + " bytes\"}\n");
+                    closeConnection(entry.fd);
+                }
+            }
+        }
+    }
+}
+
+#else
+
+bool MiningServer::sendAll(int, const std::string&) {
+    return false;
+}
+
+void MiningServer::run() {
+    throw std::runtime_error("Server mode needs Unix-domain sockets, which this build does not support");
+}
+
+#endif
@@ -6,37 +6,171 @@
 #include "neighborhood_mgr.h"
 #include "utils.h"
 #include <algorithm>
+#include <numeric>
+#include <string_view>
+#include <omp.h>
 
 void NeighborhoodMgr::buildFromPairs(const std::vector<std::pair<SpatialInstance, SpatialInstance>>& pairs) {
     // Build star neighborhoods from neighbor pairs
     // A star neighborhood has a center instance and all its neighbors
-    
-    for (const auto& pair : pairs) {
-        const SpatialInstance& center = pair.first;
-        const SpatialInstance& neighbor = pair.second;
-        
-        // Get or create the vector of star neighborhoods for this feature type
-        auto& vec = starNeighborhoods[pair.first.type];
-
-        // Search for existing star neighborhood with this center
-        auto it = std::find_if(vec.begin(), vec.end(), [&](const StarNeighborhood& sn) {
-            return sn.center->id == center.id;
-        });
-
-        if (it != vec.end()) {
-            // Star neighborhood already exists, add this neighbor to it
-            it->neighbors.push_back(&neighbor);
-        } else {
-            // Create new star neighborhood with this center
-            StarNeighborhood newStarNeigh;
-            newStarNeigh.center = &center;
-            newStarNeigh.neighbors.push_back(&neighbor);
-            vec.push_back(newStarNeigh);
+
+    // Order pairs by center, then by neighbor feature and feature index, so that
+    // each center's neighbors form one sorted run
+    std::vector<size_t> sorted(pairs.size());
+    std::iota(sorted.begin(), sorted.end(), 0);
+    std::sort(sorted.begin(), sorted.end(), [&](size_t a, size_t b) {
+        const auto& pa = pairs[a];
+        const auto& pb = pairs[b];
+        if (pa.first.id != pb.first.id) return pa.first.id < pb.first.id;
+        if (pa.second.feature != pb.second.feature) return pa.second.feature < pb.second.feature;
+        return pa.second.featureIndex < pb.second.featureIndex;
+    });
+
+    // Every pair holds its own copies of the instances; use the first copy of
+    // each instance everywhere so that pointers identify instances
+    std::unordered_map<std::string_view, const SpatialInstance*> canonical;
+    canonical.reserve(pairs.size());
+    auto canonicalOf = [&](const SpatialInstance& instance) {
+        return canonical.emplace(instance.id, &instance).first->second;
+    };
+
+    std::vector<const SpatialInstance*> centers;
+    std::vector<size_t> offsets;
+    neighborPool.clear();
+    neighborPool.reserve(pairs.size());
+
+    for (size_t p = 0; p < sorted.size(); ++p) {
+        const auto& pair = pairs[sorted[p]];
+
+        // Start a new star whenever the center changes
+        if (centers.empty() || centers.back()->id != pair.first.id) {
+            centers.push_back(canonicalOf(pair.first));
+            offsets.push_back(neighborPool.size());
+        }
+        neighborPool.push_back(canonicalOf(pair.second));
+    }
+    offsets.push_back(neighborPool.size());
+
+    finalizeStars(centers, offsets);
+}
+
+void NeighborhoodMgr::buildFromIndex(const std::vector<SpatialInstance>& instances, SpatialIndex& index) {
+    // Star neighbor indices of every instance, in CSR form
+    std::vector<size_t> offsets;
+    std::vector<uint32_t> neighborIdx;
+    index.findStarNeighbors(instances, offsets, neighborIdx);
+
+    buildFromStarLists(instances, offsets, std::move(neighborIdx));
+}
+
+void NeighborhoodMgr::buildFromStarLists(const std::vector<SpatialInstance>& instances,
+                                         const std::vector<size_t>& offsets,
+                                         std::vector<uint32_t> neighborIdx) {
+    neighborPool.resize(neighborIdx.size());
+    #pragma omp parallel for
+    for (int64_t j = 0; j < static_cast<int64_t>(neighborIdx.size()); ++j) {
+        neighborPool[j] = &instances[neighborIdx[j]];
+    }
+    std::vector<uint32_t>().swap(neighborIdx);
+
+    std::vector<const SpatialInstance*> centers(instances.size());
+    for (size_t i = 0; i < instances.size(); ++i) {
+        centers[i] = &instances[i];
+    }
+
+    finalizeStars(centers, offsets);
+}
+
+void NeighborhoodMgr::finalizeStars(const std::vector<const SpatialInstance*>& centers, const std::vector<size_t>& offsets) {
+    int64_t numCenters = static_cast<int64_t>(centers.size());
+
+    // Count the distinct neighbor features of every star
+    std::vector<size_t> groupOffsets(centers.size() + 1, 0);
+    #pragma omp parallel for
+    for (int64_t c = 0; c < numCenters; ++c) {
+        size_t groups = 0;
+        for (size_t n = offsets[c]; n < offsets[c + 1]; ++n) {
+            if (n == offsets[c] || neighborPool[n]->feature != neighborPool[n - 1]->feature) {
+                ++groups;
+            }
+        }
+        groupOffsets[c + 1] = groups;
+    }
+    std::partial_sum(groupOffsets.begin(), groupOffsets.end(), groupOffsets.begin());
+
+    // Record where each feature's run starts and ends inside its star
+    groupPool.resize(groupOffsets.back());
+    #pragma omp parallel for
+    for (int64_t c = 0; c < numCenters; ++c) {
+        size_t g = groupOffsets[c];
+        for (size_t n = offsets[c]; n < offsets[c + 1]; ++n) {
+            uint32_t local = static_cast<uint32_t>(n - offsets[c]);
+            FeatureCode feature = neighborPool[n]->feature;
+            if (n == offsets[c] || feature != neighborPool[n - 1]->feature) {
+                groupPool[g++] = {feature, local, local + 1};
+            } else {
+                groupPool[g - 1].end = local + 1;
+            }
+        }
+    }
+
+    // Only instances with at least one star neighbor get a star
+    starNeighborhoods.clear();
+    for (int64_t c = 0; c < numCenters; ++c) {
+        if (offsets[c + 1] == offsets[c]) continue;
+
+        StarNeighborhood star;
+        star.center = centers[c];
+        star.neighbors = {neighborPool.data() + offsets[c], offsets[c + 1] - offsets[c]};
+        star.groups = {groupPool.data() + groupOffsets[c], groupOffsets[c + 1] - groupOffsets[c]};
+        for (const auto& group : star.groups) {
+            star.presence.set(group.feature);
+        }
+        starNeighborhoods[centers[c]->type].push_back(star);
+    }
+
+    // Index the stars by (center feature, center feature index) for adjacency checks
+    starLookupOffsets.clear();
+    for (int64_t c = 0; c < numCenters; ++c) {
+        FeatureCode feature = centers[c]->feature;
+        if (starLookupOffsets.size() < feature + 2) {
+            starLookupOffsets.resize(feature + 2, 0);
+        }
+        starLookupOffsets[feature + 1] = std::max<size_t>(starLookupOffsets[feature + 1], centers[c]->featureIndex + 1);
+    }
+    std::partial_sum(starLookupOffsets.begin(), starLookupOffsets.end(), starLookupOffsets.begin());
+
+    starLookup.assign(starLookupOffsets.empty() ? 0 : starLookupOffsets.back(), nullptr);
+    for (const auto& entry : starNeighborhoods) {
+        for (const auto& star : entry.second) {
+            starLookup[starLookupOffsets[star.center->feature] + star.center->featureIndex] = &star;
         }
     }
-    return;
 }
 
 const std::unordered_map<FeatureType, std::vector<StarNeighborhood>>& NeighborhoodMgr::getAllStarNeighborhoods() const {
     return starNeighborhoods;
-}
\ No newline at end of file
+}
+
+const StarNeighborhood* NeighborhoodMgr::findStar(const SpatialInstance* center) const {
+    size_t feature = center->feature;
+    if (feature + 1 >= starLookupOffsets.size()) return nullptr;
+
+    size_t slot = starLookupOffsets[feature] + center->featureIndex;
+    return slot < starLookupOffsets[feature + 1] ? starLookup[slot] : nullptr;
+}
+
+bool NeighborhoodMgr::areNeighbors(const SpatialInstance* a, const SpatialInstance* b) const {
+    const StarNeighborhood* star = findStar(a);
+    if (star == nullptr) return false;
+
+    const NeighborGroup* group = star->findGroup(b->feature);
+    if (group == nullptr) return false;
+
+    // Neighbors of one feature are sorted by feature index
+    auto first = star->neighbors.begin() + group->begin;
+    auto last = star->neighbors.begin() + group->end;
+    auto it = std::lower_bound(first, last, b->featureIndex,
+        [](const SpatialInstance* n, uint32_t index) { return n->featureIndex < index; });
+    return it != last && *it == b;
+}
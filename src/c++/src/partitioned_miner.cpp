@@ -0,0 +1,586 @@
+/**
+ * @file partitioned_miner.cpp
+ * @brief Implementation of tiled, multi-process colocation mining
+ */
+
+#include "partitioned_miner.h"
+#include "tile_worker.h"
+#include "miner.h"
+#include "utils.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <unordered_map>
+#include <omp.h>
+
+#ifndef _WIN32
+#include <cerrno>
+#include <csignal>
+#include <string>
+#include <fcntl.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+// Participants reported for a level: candidate -> slot -> dataset feature indices
+using Participants = std::vector<std::vector<std::vector<uint32_t>>>;
+
+std::vector<std::unique_ptr<TileWorker>> buildTiles(
+    const std::vector<SpatialInstance>& instances,
+    const std::vector<std::vector<uint32_t>>& members,
+    const std::vector<std::vector<char>>& owned,
+    double distance,
+    size_t numFeatures)
+{
+    std::vector<std::unique_ptr<TileWorker>> tiles;
+    for (size_t t = 0; t < members.size(); ++t) {
+        std::vector<SpatialInstance> tileInstances;
+        tileInstances.reserve(members[t].size());
+        for (uint32_t i : members[t]) {
+            tileInstances.push_back(instances[i]);
+        }
+        tiles.push_back(std::make_unique<TileWorker>(std::move(tileInstances), owned[t], distance, numFeatures));
+    }
+    return tiles;
+}
+
+void evaluateTiles(const std::vector<std::unique_ptr<TileWorker>>& tiles,
+                   const std::vector<Pattern>& candidates,
+                   Participants& participants)
+{
+    participants.assign(candidates.size(), {});
+    #pragma omp parallel for schedule(dynamic)
+    for (int64_t c = 0; c < static_cast<int64_t>(candidates.size()); ++c) {
+        participants[c].resize(candidates[c].size());
+        for (const auto& tile : tiles) {
+            tile->collectParticipants(candidates[c], participants[c]);
+        }
+    }
+}
+
+#ifndef _WIN32
+
+struct WorkerProcess {
+    pid_t pid;     ///< Process ID of the worker
+    int requests;  ///< Write end of the candidate pipe
+    int replies;   ///< Read end of the participant pipe
+};
+
+void writeAll(int fd, const void* data, size_t bytes) {
+    const char* p = static_cast<const char*>(data);
+    while (bytes > 0) {
+        ssize_t n = ::write(fd, p, bytes);
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0 && errno == EPIPE) {
+            throw std::runtime_error("Partitioned mining: worker process exited unexpectedly");
+        }
+        if (n <= 0) throw std::runtime_error("Partitioned mining: write to worker pipe failed");
+        p += n;
+        bytes -= static_cast<size_t>(n);
+    }
+}
+
+void readAll(int fd, void* data, size_t bytes) {
+    char* p = static_cast<char*>(data);
+    while (bytes > 0) {
+        ssize_t n = ::read(fd, p, bytes);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) throw std::runtime_error("Partitioned mining: worker pipe closed unexpectedly");
+        p += n;
+        bytes -= static_cast<size_t>(n);
+    }
+}
+
+// Candidates of one level: count, size, then the codes; a count of 0 stops the worker
+void writeCandidates(int fd, const std::vector<Pattern>& candidates) {
+    uint32_t header[2] = {
+        static_cast<uint32_t>(candidates.size()),
+        static_cast<uint32_t>(candidates.empty() ? 0 : candidates[0].size())
+    };
+    std::vector<uint32_t> codes;
+    codes.reserve(candidates.size() * header[1]);
+    for (const auto& pattern : candidates) {
+        codes.insert(codes.end(), pattern.begin(), pattern.end());
+    }
+    writeAll(fd, header, sizeof(header));
+    writeAll(fd, codes.data(), codes.size() * sizeof(uint32_t));
+}
+
+bool readCandidates(int fd, std::vector<Pattern>& candidates) {
+    uint32_t header[2];
+    readAll(fd, header, sizeof(header));
+    if (header[0] == 0) return false;
+
+    std::vector<uint32_t> codes(static_cast<size_t>(header[0]) * header[1]);
+    readAll(fd, codes.data(), codes.size() * sizeof(uint32_t));
+    candidates.clear();
+    for (size_t c = 0; c < header[0]; ++c) {
+        candidates.emplace_back(codes.data() + c * header[1], header[1]);
+    }
+    return true;
+}
+
+// Participants of one level: for every candidate and slot, a count and the indices
+void writeParticipants(int fd, const Participants& participants) {
+    for (const auto& slots : participants) {
+        for (const auto& list : slots) {
+            uint32_t n = static_cast<uint32_t>(list.size());
+            writeAll(fd, &n, sizeof(n));
+            writeAll(fd, list.data(), list.size() * sizeof(uint32_t));
+        }
+    }
+}
+
+template <typename T>
+void writeArray(int fd, const std::vector<T>& values) {
+    writeAll(fd, values.data(), values.size() * sizeof(T));
+}
+
+template <typename T>
+void readArray(int fd, std::vector<T>& values, size_t count) {
+    values.resize(count);
+    readAll(fd, values.data(), count * sizeof(T));
+}
+
+// Worker setup: distance, threads, feature names, then each tile's members
+// (coordinates, feature codes and indices, core flags)
+void writeSetup(int fd, double distance, int32_t threads, const std::vector<FeatureType>& featureTypes,
+                const std::vector<SpatialInstance>& instances,
+                const std::vector<std::vector<uint32_t>>& members,
+                const std::vector<std::vector<char>>& owned)
+{
+    uint32_t numFeatures = static_cast<uint32_t>(featureTypes.size());
+    uint32_t numTiles = static_cast<uint32_t>(members.size());
+    writeAll(fd, &distance, sizeof(distance));
+    writeAll(fd, &threads, sizeof(threads));
+    writeAll(fd, &numFeatures, sizeof(numFeatures));
+    for (const auto& name : featureTypes) {
+        uint32_t length = static_cast<uint32_t>(name.size());
+        writeAll(fd, &length, sizeof(length));
+        writeAll(fd, name.data(), length);
+    }
+    writeAll(fd, &numTiles, sizeof(numTiles));
+
+    std::vector<double> xs, ys;
+    std::vector<uint32_t> features, indices;
+    for (size_t t = 0; t < members.size(); ++t) {
+        uint32_t n = static_cast<uint32_t>(members[t].size());
+        xs.clear(); ys.clear(); features.clear(); indices.clear();
+        for (uint32_t i : members[t]) {
+            xs.push_back(instances[i].x);
+            ys.push_back(instances[i].y);
+            features.push_back(instances[i].feature);
+            indices.push_back(instances[i].featureIndex);
+        }
+        writeAll(fd, &n, sizeof(n));
+        writeArray(fd, xs);
+        writeArray(fd, ys);
+        writeArray(fd, features);
+        writeArray(fd, indices);
+        writeArray(fd, owned[t]);
+    }
+}
+
+std::vector<std::unique_ptr<TileWorker>> readSetup(int fd) {
+    double distance = 0.0;
+    int32_t threads = 1;
+    uint32_t numFeatures = 0, numTiles = 0;
+    readAll(fd, &distance, sizeof(distance));
+    readAll(fd, &threads, sizeof(threads));
+    omp_set_num_threads(std::max(1, threads));
+
+    readAll(fd, &numFeatures, sizeof(numFeatures));
+    std::vector<FeatureType> featureTypes(numFeatures);
+    for (auto& name : featureTypes) {
+        uint32_t length = 0;
+        readAll(fd, &length, sizeof(length));
+        name.resize(length);
+        readAll(fd, &name[0], length);
+    }
+    readAll(fd, &numTiles, sizeof(numTiles));
+
+    std::vector<std::unique_ptr<TileWorker>> tiles;
+    std::vector<double> xs, ys;
+    std::vector<uint32_t> features, indices;
+    for (uint32_t t = 0; t < numTiles; ++t) {
+        uint32_t n = 0;
+        readAll(fd, &n, sizeof(n));
+        std::vector<char> owned;
+        readArray(fd, xs, n);
+        readArray(fd, ys, n);
+        readArray(fd, features, n);
+        readArray(fd, indices, n);
+        readArray(fd, owned, n);
+
+        std::vector<SpatialInstance> tileInstances(n);
+        for (uint32_t i = 0; i < n; ++i) {
+            if (features[i] >= numFeatures) {
+                throw std::runtime_error("Partitioned mining: invalid feature code from coordinator");
+            }
+            tileInstances[i].type = featureTypes[features[i]];
+            tileInstances[i].x = xs[i];
+            tileInstances[i].y = ys[i];
+            tileInstances[i].feature = static_cast<FeatureCode>(features[i]);
+            tileInstances[i].featureIndex = indices[i];
+        }
+        tiles.push_back(std::make_unique<TileWorker>(std::move(tileInstances), std::move(owned),
+                                                     distance, numFeatures));
+    }
+    return tiles;
+}
+
+// Worker processes of one run; closing their pipes makes them exit, so an
+// exception in the coordinator does not leave them behind
+struct WorkerGroup {
+    std::vector<WorkerProcess> processes;
+
+    ~WorkerGroup() {
+        for (const auto& process : processes) {
+            close(process.requests);
+            close(process.replies);
+        }
+        for (const auto& process : processes) {
+            waitpid(process.pid, nullptr, 0);
+        }
+    }
+};
+
+void serveTiles(int requests, int replies, const std::vector<std::unique_ptr<TileWorker>>& tiles) {
+    std::vector<Pattern> candidates;
+    Participants participants;
+    while (readCandidates(requests, candidates)) {
+        evaluateTiles(tiles, candidates, participants);
+        writeParticipants(replies, participants);
+    }
+}
+
+#endif
+
+} // namespace
+
+
+PartitionedMiner::PartitionedMiner(double distThresh, size_t tiles, size_t workers)
+    : distanceThreshold(distThresh),
+      tilesPerSide(std::max<size_t>(1, tiles)),
+      numWorkers(std::max<size_t>(1, workers)) {}
+
+
+void PartitionedMiner::setWorkerExecutable(const std::string& path) {
+    workerExecutable = path;
+}
+
+
+int PartitionedMiner::runWorker(int requests, int replies) {
+#ifndef _WIN32
+    // The coordinator's SIGPIPE disposition survives exec; a worker whose
+    // coordinator is gone just ends
+    std::signal(SIGPIPE, SIG_DFL);
+    try {
+        std::vector<std::unique_ptr<TileWorker>> tiles = readSetup(requests);
+        serveTiles(requests, replies, tiles);
+    } catch (const std::exception& e) {
+        std::cerr << "Partitioned mining worker: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+#else
+    (void)requests;
+    (void)replies;
+    std::cerr << "Partitioned mining workers need a POSIX system\n";
+    return 1;
+#endif
+}
+
+
+std::vector<PartitionedMiner::Tile> PartitionedMiner::partition(const std::vector<SpatialInstance>& instances) const {
+    double minX = instances[0].x, maxX = instances[0].x;
+    double minY = instances[0].y, maxY = instances[0].y;
+    for (const auto& inst : instances) {
+        minX = std::min(minX, inst.x);
+        maxX = std::max(maxX, inst.x);
+        minY = std::min(minY, inst.y);
+        maxY = std::max(maxY, inst.y);
+    }
+
+    size_t g = tilesPerSide;
+    double width = std::max((maxX - minX) / g, 1e-9);
+    double height = std::max((maxY - minY) / g, 1e-9);
+    auto column = [&](double x) {
+        return static_cast<size_t>(std::min<double>(g - 1, std::max(0.0, std::floor((x - minX) / width))));
+    };
+    auto row = [&](double y) {
+        return static_cast<size_t>(std::min<double>(g - 1, std::max(0.0, std::floor((y - minY) / height))));
+    };
+
+    std::vector<Tile> grid(g * g);
+    for (uint32_t i = 0; i < instances.size(); ++i) {
+        const SpatialInstance& inst = instances[i];
+        size_t ownX = column(inst.x);
+        size_t ownY = row(inst.y);
+
+        // Core tile, plus every tile whose core is within the distance (its halo)
+        for (size_t tx = column(inst.x - distanceThreshold); tx <= column(inst.x + distanceThreshold); ++tx) {
+            for (size_t ty = row(inst.y - distanceThreshold); ty <= row(inst.y + distanceThreshold); ++ty) {
+                bool core = tx == ownX && ty == ownY;
+                if (!core) {
+                    double x0 = minX + tx * width, x1 = (tx + 1 == g) ? maxX : x0 + width;
+                    double y0 = minY + ty * height, y1 = (ty + 1 == g) ? maxY : y0 + height;
+                    double dx = std::max({0.0, x0 - inst.x, inst.x - x1});
+                    double dy = std::max({0.0, y0 - inst.y, inst.y - y1});
+                    if (dx * dx + dy * dy > distanceThreshold * distanceThreshold * (1.0 + 1e-9)) continue;
+                }
+                Tile& tile = grid[tx * g + ty];
+                tile.members.push_back(i);
+                tile.owned.push_back(core);
+            }
+        }
+    }
+
+    std::vector<Tile> tiles;
+    for (auto& tile : grid) {
+        if (std::find(tile.owned.begin(), tile.owned.end(), 1) != tile.owned.end()) {
+            tiles.push_back(std::move(tile));
+        }
+    }
+    return tiles;
+}
+
+
+void PartitionedMiner::estimateCosts(const std::vector<SpatialInstance>& instances, std::vector<Tile>& tiles) const {
+    auto cellKey = [](int64_t cx, int64_t cy) {
+        return (static_cast<uint64_t>(static_cast<uint32_t>(cx)) << 32) | static_cast<uint32_t>(cy);
+    };
+
+    std::unordered_map<uint64_t, uint32_t> cellCounts;
+    for (const auto& inst : instances) {
+        cellCounts[cellKey(static_cast<int64_t>(std::floor(inst.x / distanceThreshold)),
+                           static_cast<int64_t>(std::floor(inst.y / distanceThreshold)))]++;
+    }
+
+    for (auto& tile : tiles) {
+        tile.cost = 0.0;
+        for (size_t m = 0; m < tile.members.size(); ++m) {
+            if (!tile.owned[m]) continue;
+            const SpatialInstance& inst = instances[tile.members[m]];
+            int64_t cx = static_cast<int64_t>(std::floor(inst.x / distanceThreshold));
+            int64_t cy = static_cast<int64_t>(std::floor(inst.y / distanceThreshold));
+            for (int64_t dx = -1; dx <= 1; ++dx) {
+                for (int64_t dy = -1; dy <= 1; ++dy) {
+                    auto it = cellCounts.find(cellKey(cx + dx, cy + dy));
+                    if (it != cellCounts.end()) tile.cost += it->second;
+                }
+            }
+        }
+    }
+}
+
+
+std::vector<std::vector<size_t>> PartitionedMiner::scheduleTiles(const std::vector<Tile>& tiles, size_t workers) {
+    std::vector<size_t> order(tiles.size());
+    for (size_t t = 0; t < tiles.size(); ++t) order[t] = t;
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        return tiles[a].cost > tiles[b].cost;
+    });
+
+    std::vector<std::vector<size_t>> assignment(workers);
+    std::vector<double> load(workers, 0.0);
+    for (size_t t : order) {
+        size_t w = std::min_element(load.begin(), load.end()) - load.begin();
+        assignment[w].push_back(t);
+        load[w] += tiles[t].cost;
+    }
+    return assignment;
+}
+
+
+std::vector<Colocation> PartitionedMiner::mineColocations(double minPrev, const std::vector<SpatialInstance>& instances) {
+    std::vector<Colocation> result;
+    if (instances.empty()) return result;
+
+    std::vector<FeatureType> featureTypes = getAllObjectTypes(instances);
+    size_t numFeatures = featureTypes.size();
+    std::vector<size_t> featureSizes(numFeatures, 0);
+    for (const auto& instance : instances) {
+        featureSizes[instance.feature]++;
+    }
+
+    // ========================================================================
+    // STEP 1: Partition the plane and schedule the tiles
+    // ========================================================================
+    std::vector<Tile> tiles = partition(instances);
+    estimateCosts(instances, tiles);
+    size_t workers = std::min(numWorkers, tiles.size());
+    std::vector<std::vector<size_t>> assignment = scheduleTiles(tiles, workers);
+
+    auto tilesOf = [&](const std::vector<size_t>& assigned) {
+        std::vector<std::vector<uint32_t>> members;
+        std::vector<std::vector<char>> owned;
+        for (size_t t : assigned) {
+            members.push_back(tiles[t].members);
+            owned.push_back(tiles[t].owned);
+        }
+        return buildTiles(instances, members, owned, distanceThreshold, numFeatures);
+    };
+
+    // ========================================================================
+    // STEP 2: Start the workers
+    // ========================================================================
+    std::vector<std::unique_ptr<TileWorker>> localTiles;
+#ifndef _WIN32
+    // Workers are fresh processes (fork, then exec of the worker executable):
+    // a child forked from a process that already ran OpenMP regions cannot
+    // start its own thread team. They get their tiles over the request pipe
+    WorkerGroup group;
+    std::vector<WorkerProcess>& processes = group.processes;
+    if (workers > 1 && !workerExecutable.empty()) {
+        // A worker that dies must fail the write with EPIPE, not kill the coordinator
+        std::signal(SIGPIPE, SIG_IGN);
+        int threadsPerWorker = std::max(1, omp_get_max_threads() / static_cast<int>(workers));
+        for (size_t w = 0; w < workers; ++w) {
+            int requestPipe[2], replyPipe[2];
+            if (pipe(requestPipe) != 0) {
+                throw std::runtime_error("Partitioned mining: cannot create worker pipes");
+            }
+            if (pipe(replyPipe) != 0) {
+                close(requestPipe[0]);
+                close(requestPipe[1]);
+                throw std::runtime_error("Partitioned mining: cannot create worker pipes");
+            }
+            // The coordinator's ends must not leak into later workers
+            fcntl(requestPipe[1], F_SETFD, FD_CLOEXEC);
+            fcntl(replyPipe[0], F_SETFD, FD_CLOEXEC);
+
+            // Everything exec needs is prepared before fork: the child only
+            // calls async-signal-safe functions
+            std::string requestFd = std::to_string(requestPipe[0]);
+            std::string replyFd = std::to_string(replyPipe[1]);
+            char* args[] = {
+                const_cast<char*>(workerExecutable.c_str()),
+                const_cast<char*>(kWorkerFlag),
+                &requestFd[0],
+                &replyFd[0],
+                nullptr
+            };
+            pid_t pid = fork();
+            if (pid == 0) {
+                execv(workerExecutable.c_str(), args);
+                _exit(127);
+            }
+            close(requestPipe[0]);
+            close(replyPipe[1]);
+            if (pid < 0) {
+                close(requestPipe[1]);
+                close(replyPipe[0]);
+                throw std::runtime_error("Partitioned mining: cannot start worker process");
+            }
+            processes.push_back({pid, requestPipe[1], replyPipe[0]});
+
+            std::vector<std::vector<uint32_t>> members;
+            std::vector<std::vector<char>> owned;
+            for (size_t t : assignment[w]) {
+                members.push_back(std::move(tiles[t].members));
+                owned.push_back(std::move(tiles[t].owned));
+            }
+            writeSetup(processes.back().requests, distanceThreshold, threadsPerWorker,
+                       featureTypes, instances, members, owned);
+        }
+    } else
+#endif
+    {
+        // Tiles are served in process, one after the other
+        std::vector<size_t> all(tiles.size());
+        for (size_t t = 0; t < tiles.size(); ++t) all[t] = t;
+        localTiles = tilesOf(all);
+    }
+    std::vector<Tile>().swap(tiles);
+
+    // ========================================================================
+    // STEP 3: Mine level by level over the global participation bitmaps
+    // ========================================================================
+    std::vector<Pattern> candidates;
+    for (FeatureCode a = 0; a < numFeatures; ++a) {
+        for (FeatureCode b = a + 1; b < numFeatures; ++b) {
+            Pattern pair;
+            pair.push_back(a);
+            pair.push_back(b);
+            candidates.push_back(pair);
+        }
+    }
+
+    std::vector<Pattern> allPrevalent;
+    while (!candidates.empty()) {
+        size_t k = candidates[0].size();
+        std::vector<ParticipationBitmap> slots(candidates.size() * k);
+        for (size_t c = 0; c < candidates.size(); ++c) {
+            for (size_t slot = 0; slot < k; ++slot) {
+                slots[c * k + slot].reset(featureSizes[candidates[c][slot]]);
+            }
+        }
+
+#ifndef _WIN32
+        if (!processes.empty()) {
+            for (const auto& process : processes) {
+                writeCandidates(process.requests, candidates);
+            }
+            std::vector<uint32_t> list;
+            for (const auto& process : processes) {
+                for (size_t i = 0; i < slots.size(); ++i) {
+                    uint32_t n = 0;
+                    readAll(process.replies, &n, sizeof(n));
+                    list.resize(n);
+                    readAll(process.replies, list.data(), n * sizeof(uint32_t));
+                    for (uint32_t index : list) {
+                        slots[i].set(index);
+                    }
+                }
+            }
+        } else
+#endif
+        {
+            Participants participants;
+            evaluateTiles(localTiles, candidates, participants);
+            for (size_t c = 0; c < candidates.size(); ++c) {
+                for (size_t slot = 0; slot < k; ++slot) {
+                    for (uint32_t index : participants[c][slot]) {
+                        slots[c * k + slot].set(index);
+                    }
+                }
+            }
+        }
+
+        std::vector<Pattern> prevalent;
+        for (size_t c = 0; c < candidates.size(); ++c) {
+            bool isPrevalent = true;
+            for (size_t slot = 0; slot < k && isPrevalent; ++slot) {
+                size_t need = JoinlessMiner::participationThreshold(minPrev, featureSizes[candidates[c][slot]]);
+                isPrevalent = slots[c * k + slot].count >= need;
+            }
+            if (isPrevalent) {
+                prevalent.push_back(candidates[c]);
+            }
+        }
+
+        allPrevalent.insert(allPrevalent.end(), prevalent.begin(), prevalent.end());
+        candidates = JoinlessMiner::generateCandidatePatterns(prevalent);
+    }
+
+#ifndef _WIN32
+    // A count of 0 stops the workers; the group then closes the pipes and reaps them
+    for (const auto& process : processes) {
+        writeCandidates(process.requests, {});
+    }
+#endif
+
+    for (const auto& pattern : allPrevalent) {
+        Colocation colocation;
+        for (FeatureCode code : pattern) {
+            colocation.push_back(featureTypes[code]);
+        }
+        result.push_back(std::move(colocation));
+    }
+    return result;
+}
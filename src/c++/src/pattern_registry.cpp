@@ -0,0 +1,20 @@
+/**
+ * @file pattern_registry.cpp
+ * @brief Implementation of the per-level pattern registry
+ */
+
+#include "pattern_registry.h"
+
+PatternId PatternRegistry::add(const Pattern& pattern) {
+    auto inserted = ids.emplace(pattern, static_cast<PatternId>(entries.size()));
+    if (inserted.second) {
+        width = pattern.size();
+        entries.push_back(pattern);
+    }
+    return inserted.first->second;
+}
+
+PatternId PatternRegistry::find(const Pattern& pattern) const {
+    auto it = ids.find(pattern);
+    return it == ids.end() ? kNone : it->second;
+}
@@ -0,0 +1,110 @@
+/**
+ * @file radix_sort.cpp
+ * @brief Implementation of the parallel radix sorts
+ */
+
+#include "radix_sort.h"
+#include <algorithm>
+#include <numeric>
+#include <omp.h>
+
+namespace {
+
+template <typename Key>
+void radixSortByKey(std::vector<Key>& keys, std::vector<uint32_t>& values) {
+    const int64_t n = static_cast<int64_t>(keys.size());
+    std::vector<Key> keysOut(keys.size());
+    std::vector<uint32_t> valuesOut(values.size());
+    const int numThreads = omp_get_max_threads();
+    std::vector<size_t> histogram(static_cast<size_t>(numThreads) * 256);
+
+    // Bits above the highest one set in any key need no pass
+    Key used = 0;
+    #pragma omp parallel for reduction(|:used)
+    for (int64_t i = 0; i < n; ++i) {
+        used |= keys[i];
+    }
+
+    for (int shift = 0; shift < static_cast<int>(sizeof(Key) * 8) && (used >> shift) != 0; shift += 8) {
+        std::fill(histogram.begin(), histogram.end(), 0);
+        bool trivial = false;
+
+        #pragma omp parallel num_threads(numThreads)
+        {
+            int tid = omp_get_thread_num();
+            int threads = omp_get_num_threads();
+            int64_t begin = n * tid / threads;
+            int64_t end = n * (tid + 1) / threads;
+            size_t* local = histogram.data() + static_cast<size_t>(tid) * 256;
+
+            for (int64_t i = begin; i < end; ++i) {
+                local[(keys[i] >> shift) & 0xff]++;
+            }
+
+            #pragma omp barrier
+            #pragma omp single
+            {
+                // Exclusive prefix sum, bucket-major then thread-major, keeps the sort stable
+                size_t offset = 0;
+                for (int bucket = 0; bucket < 256; ++bucket) {
+                    size_t bucketStart = offset;
+                    for (int t = 0; t < threads; ++t) {
+                        size_t count = histogram[static_cast<size_t>(t) * 256 + bucket];
+                        histogram[static_cast<size_t>(t) * 256 + bucket] = offset;
+                        offset += count;
+                    }
+                    // Every key has this digit: the pass would not move anything
+                    if (offset - bucketStart == static_cast<size_t>(n)) trivial = true;
+                }
+            }
+
+            if (!trivial) {
+                for (int64_t i = begin; i < end; ++i) {
+                    size_t dst = local[(keys[i] >> shift) & 0xff]++;
+                    keysOut[dst] = keys[i];
+                    valuesOut[dst] = values[i];
+                }
+            }
+        }
+
+        if (!trivial) {
+            keys.swap(keysOut);
+            values.swap(valuesOut);
+        }
+    }
+}
+
+} // namespace
+
+void radixSortPairs(std::vector<uint32_t>& keys, std::vector<uint32_t>& values) {
+    radixSortByKey(keys, values);
+}
+
+void radixSortPairs(std::vector<uint64_t>& keys, std::vector<uint32_t>& values) {
+    radixSortByKey(keys, values);
+}
+
+void radixSortTuples(std::vector<uint32_t>& tuples, size_t width, std::vector<uint32_t>& order) {
+    const int64_t count = width == 0 ? 0 : static_cast<int64_t>(tuples.size() / width);
+    order.resize(static_cast<size_t>(count));
+    std::iota(order.begin(), order.end(), 0);
+
+    // LSD over columns: a stable sort by each column, last column first
+    std::vector<uint32_t> column(static_cast<size_t>(count));
+    for (size_t col = width; col-- > 0;) {
+        #pragma omp parallel for
+        for (int64_t i = 0; i < count; ++i) {
+            column[i] = tuples[static_cast<size_t>(order[i]) * width + col];
+        }
+        radixSortPairs(column, order);
+    }
+
+    // Rewrite the tuples in sorted order
+    std::vector<uint32_t> sorted(tuples.size());
+    #pragma omp parallel for
+    for (int64_t i = 0; i < count; ++i) {
+        std::copy_n(tuples.data() + static_cast<size_t>(order[i]) * width, width,
+                    sorted.data() + static_cast<size_t>(i) * width);
+    }
+    tuples.swap(sorted);
+}
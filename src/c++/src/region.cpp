@@ -0,0 +1,132 @@
+/**
+ * @file region.cpp
+ * @brief Implementation of region parsing and point containment
+ */
+
+#include "region.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <stdexcept>
+
+namespace {
+
+// Skip spaces, then check for and consume one expected character
+bool consume(const std::string& text, size_t& pos, char expected) {
+    while (pos < text.size() && std::isspace(static_cast<unsigned char>(text[pos]))) ++pos;
+    if (pos < text.size() && text[pos] == expected) {
+        ++pos;
+        return true;
+    }
+    return false;
+}
+
+// Read one number, skipping the spaces before it
+double number(const std::string& text, size_t& pos) {
+    while (pos < text.size() && std::isspace(static_cast<unsigned char>(text[pos]))) ++pos;
+    const char* begin = text.c_str() + pos;
+    char* end = nullptr;
+    double value = std::strtod(begin, &end);
+    if (end == begin) {
+        throw std::invalid_argument("Region: number expected at position " + std::to_string(pos));
+    }
+    pos += end - begin;
+    return value;
+}
+
+} // namespace
+
+
+Region Region::parse(const std::string& spec) {
+    Region region;
+    std::string upper(spec);
+    std::transform(upper.begin(), upper.end(), upper.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::toupper(c)); });
+    size_t keyword = upper.find("POLYGON");
+
+    if (keyword == std::string::npos) {
+        // Rectangle: minX,minY,maxX,maxY
+        size_t pos = 0;
+        double values[4];
+        for (int i = 0; i < 4; ++i) {
+            if (i > 0 && !consume(spec, pos, ',')) {
+                throw std::invalid_argument("Region: expected minX,minY,maxX,maxY or a WKT POLYGON");
+            }
+            values[i] = number(spec, pos);
+        }
+        region.left = values[0];
+        region.bottom = values[1];
+        region.right = values[2];
+        region.top = values[3];
+        if (region.left > region.right || region.bottom > region.top) {
+            throw std::invalid_argument("Region: rectangle minimum exceeds its maximum");
+        }
+        return region;
+    }
+
+    // Polygon: POLYGON((x y, x y, ...), (x y, ...))
+    size_t pos = keyword + 7;
+    if (!consume(spec, pos, '(')) {
+        throw std::invalid_argument("Region: '(' expected after POLYGON");
+    }
+    do {
+        if (!consume(spec, pos, '(')) {
+            throw std::invalid_argument("Region: '(' expected before a polygon ring");
+        }
+        std::vector<std::pair<double, double>> ring;
+        do {
+            double x = number(spec, pos);
+            double y = number(spec, pos);
+            ring.emplace_back(x, y);
+        } while (consume(spec, pos, ','));
+        if (!consume(spec, pos, ')')) {
+            throw std::invalid_argument("Region: ')' expected after a polygon ring");
+        }
+        // WKT repeats the first vertex at the end; the edge loop closes rings itself
+        if (ring.size() > 1 && ring.front() == ring.back()) {
+            ring.pop_back();
+        }
+        if (ring.size() < 3) {
+            throw std::invalid_argument("Region: a polygon ring needs at least 3 vertices");
+        }
+        region.rings.push_back(std::move(ring));
+    } while (consume(spec, pos, ','));
+    if (!consume(spec, pos, ')')) {
+        throw std::invalid_argument("Region: ')' expected after the polygon rings");
+    }
+
+    // Holes lie inside the outline, so its vertices give the bounding box
+    const auto& outline = region.rings.front();
+    region.left = region.right = outline.front().first;
+    region.bottom = region.top = outline.front().second;
+    for (const auto& vertex : outline) {
+        region.left = std::min(region.left, vertex.first);
+        region.right = std::max(region.right, vertex.first);
+        region.bottom = std::min(region.bottom, vertex.second);
+        region.top = std::max(region.top, vertex.second);
+    }
+    return region;
+}
+
+
+bool Region::contains(double x, double y) const {
+    if (x < left || x > right || y < bottom || y > top) {
+        return false;
+    }
+    if (rings.empty()) {
+        return true;
+    }
+
+    // Even-odd rule: count the edges crossed by a ray towards +x
+    bool inside = false;
+    for (const auto& ring : rings) {
+        for (size_t i = 0, j = ring.size() - 1; i < ring.size(); j = i++) {
+            double xi = ring[i].first, yi = ring[i].second;
+            double xj = ring[j].first, yj = ring[j].second;
+            if ((yi > y) != (yj > y) && x < (xj - xi) * (y - yi) / (yj - yi) + xi) {
+                inside = !inside;
+            }
+        }
+    }
+    return inside;
+}
@@ -0,0 +1,123 @@
+/**
+ * @file region_view.cpp
+ * @brief Implementation of region extraction from a resident dataset
+ */
+
+#include "region_view.h"
+#include "utils.h"
+#include <algorithm>
+#include <unordered_map>
+#include <unordered_set>
+
+RegionView::RegionView(const Region& region, const std::vector<SpatialInstance>& dataset, double distance,
+                       const SpatialIndex& index, const NeighborhoodMgr& stars) {
+    // ========================================================================
+    // STEP 1: CORE, BY RANGE QUERY
+    // ========================================================================
+    std::vector<uint32_t> core;
+    index.queryBox(region.minX(), region.minY(), region.maxX(), region.maxY(), core);
+    if (region.isPolygon()) {
+        core.erase(std::remove_if(core.begin(), core.end(), [&](uint32_t i) {
+            return !region.contains(dataset[i].x, dataset[i].y);
+        }), core.end());
+    }
+
+    // Region position of each selected dataset position
+    std::unordered_map<uint32_t, uint32_t> position;
+    position.reserve(core.size() * 2);
+    for (uint32_t i : core) {
+        position.emplace(i, static_cast<uint32_t>(position.size()));
+    }
+    auto starOf = [&](uint32_t i) { return stars.findStar(&dataset[i]); };
+    auto datasetPosition = [&](const SpatialInstance* instance) {
+        return static_cast<uint32_t>(instance - dataset.data());
+    };
+
+    // ========================================================================
+    // STEP 2: HALO, FROM THE STARS
+    // ========================================================================
+    // A neighbor of a core instance is either in its star (greater feature) or
+    // has it in its own star (smaller feature); the latter lie within one
+    // distance of the region's bounding box
+    std::unordered_set<FeatureCode> coreFeatures;
+    for (uint32_t i : core) {
+        coreFeatures.insert(dataset[i].feature);
+    }
+
+    std::vector<uint32_t> halo;
+    auto addHalo = [&](uint32_t i) {
+        if (coreFeatures.count(dataset[i].feature) && position.find(i) == position.end()) {
+            halo.push_back(i);
+        }
+    };
+    for (uint32_t i : core) {
+        if (const StarNeighborhood* star = starOf(i)) {
+            for (const SpatialInstance* neighbor : star->neighbors) {
+                addHalo(datasetPosition(neighbor));
+            }
+        }
+    }
+
+    std::vector<uint32_t> nearby;
+    index.queryBox(region.minX() - distance, region.minY() - distance,
+                   region.maxX() + distance, region.maxY() + distance, nearby);
+    for (uint32_t i : nearby) {
+        if (position.count(i)) continue;
+        const StarNeighborhood* star = starOf(i);
+        if (star == nullptr) continue;
+        for (const SpatialInstance* neighbor : star->neighbors) {
+            if (position.count(datasetPosition(neighbor))) {
+                addHalo(i);
+                break;
+            }
+        }
+    }
+    std::sort(halo.begin(), halo.end());
+    halo.erase(std::unique(halo.begin(), halo.end()), halo.end());
+    for (uint32_t i : halo) {
+        position.emplace(i, static_cast<uint32_t>(position.size()));
+    }
+
+    // ========================================================================
+    // STEP 3: REGION INSTANCES, CORE FIRST
+    // ========================================================================
+    coreCount = core.size();
+    instances.reserve(core.size() + halo.size());
+    for (uint32_t i : core) instances.push_back(dataset[i]);
+    for (uint32_t i : halo) instances.push_back(dataset[i]);
+
+    // Feature indices follow positions, so core instances come first in each feature
+    std::vector<FeatureType> types = assignFeatureCodes(instances);
+    coreSizes.assign(types.size(), 0);
+    for (size_t r = 0; r < coreCount; ++r) {
+        coreSizes[instances[r].feature]++;
+    }
+
+    // ========================================================================
+    // STEP 4: STARS RESTRICTED TO THE REGION
+    // ========================================================================
+    // Codes keep the order of the dataset's codes, so star neighbors stay the
+    // neighbors with a greater feature; each list is re-sorted by region position
+    std::vector<uint32_t> selected(core);
+    selected.insert(selected.end(), halo.begin(), halo.end());
+    std::vector<size_t> offsets(instances.size() + 1, 0);
+    std::vector<uint32_t> neighbors;
+    for (size_t r = 0; r < selected.size(); ++r) {
+        size_t begin = neighbors.size();
+        if (const StarNeighborhood* star = starOf(selected[r])) {
+            for (const SpatialInstance* neighbor : star->neighbors) {
+                auto it = position.find(datasetPosition(neighbor));
+                if (it != position.end()) {
+                    neighbors.push_back(it->second);
+                }
+            }
+        }
+        std::sort(neighbors.begin() + begin, neighbors.end(), [&](uint32_t a, uint32_t b) {
+            return instances[a].feature != instances[b].feature
+                ? instances[a].feature < instances[b].feature
+                : a < b;
+        });
+        offsets[r + 1] = neighbors.size();
+    }
+    neighborhoods.buildFromStarLists(instances, offsets, std::move(neighbors));
+}
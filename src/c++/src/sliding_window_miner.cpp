@@ -0,0 +1,55 @@
+/**
+ * @file sliding_window_miner.cpp
+ * @brief Implementation of sliding-window colocation mining
+ */
+
+#include "sliding_window_miner.h"
+#include <algorithm>
+#include <limits>
+
+SlidingWindowMiner::SlidingWindowMiner(double distThresh, double minPrevalence, double windowLen)
+    : engine(distThresh, minPrevalence),
+      windowLength(windowLen),
+      now(-std::numeric_limits<double>::infinity()) {}
+
+
+MiningDelta SlidingWindowMiner::advance(const std::vector<SpatialEvent>& arrivals, double until) {
+    now = std::max(now, until);
+    double start = now - windowLength;
+
+    std::vector<SpatialInstance> inserted;
+    std::vector<instanceID> deleted;
+
+    for (const auto& event : arrivals) {
+        if (event.timestamp <= start || event.timestamp > now) continue;
+
+        // Keep the window in timestamp order; arrivals are normally appended
+        auto pos = window.end();
+        if (!window.empty() && window.back().timestamp > event.timestamp) {
+            pos = std::upper_bound(window.begin(), window.end(), event.timestamp,
+                [](double t, const SpatialEvent& e) { return t < e.timestamp; });
+        }
+        window.insert(pos, event);
+
+        // A later observation of a live instance replaces it
+        auto it = latest.find(event.instance.id);
+        if (it == latest.end() || it->second <= event.timestamp) {
+            latest[event.instance.id] = event.timestamp;
+            inserted.push_back(event.instance);
+        }
+    }
+
+    // Expire the events that fell out of the window; an instance only leaves
+    // when the observation that is live expires
+    while (!window.empty() && window.front().timestamp <= start) {
+        const SpatialEvent& event = window.front();
+        auto it = latest.find(event.instance.id);
+        if (it != latest.end() && it->second == event.timestamp) {
+            deleted.push_back(event.instance.id);
+            latest.erase(it);
+        }
+        window.pop_front();
+    }
+
+    return engine.applyBatch(inserted, deleted);
+}
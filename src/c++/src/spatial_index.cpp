@@ -7,6 +7,9 @@
 #include <cmath>
 #include <iostream>
 #include <algorithm>
+#include <numeric>
+#include <stdexcept>
+#include <omp.h>
 
 SpatialIndex::SpatialIndex(double distThresh)
     : distanceThreshold(distThresh)
@@ -14,68 +17,196 @@ SpatialIndex::SpatialIndex(double distThresh)
 
 }
 
-double SpatialIndex::euclideanDist(const SpatialInstance& a, const SpatialInstance& b) {
+double SpatialIndex::euclideanDist(const SpatialInstance& a, const SpatialInstance& b) const {
     // Calculate Euclidean distance using the Pythagorean theorem
     double dx = a.x - b.x;
     double dy = a.y - b.y;
     return std::sqrt(dx * dx + dy * dy);
 }
 
-std::vector<std::pair<SpatialInstance, SpatialInstance>> SpatialIndex::findNeighborPair(const std::vector<SpatialInstance>& instances) {
-    std::vector<std::pair<SpatialInstance, SpatialInstance>> neighborPairs;
+uint64_t SpatialIndex::cellKey(int64_t cx, int64_t cy) {
+    return (static_cast<uint64_t>(static_cast<uint32_t>(cx)) << 32) | static_cast<uint32_t>(cy);
+}
+
+void SpatialIndex::build(const std::vector<SpatialInstance>& instances) {
+    indexed = &instances;
+    cellRoots.clear();
+    cellKeys.clear();
+    nodes.clear();
+
+    // Compute the grid cell of every instance; cells are d x d squares
+    std::vector<uint64_t> keys(instances.size());
+    for (size_t i = 0; i < instances.size(); ++i) {
+        int64_t cx = static_cast<int64_t>(std::floor(instances[i].x / distanceThreshold));
+        int64_t cy = static_cast<int64_t>(std::floor(instances[i].y / distanceThreshold));
+        keys[i] = cellKey(cx, cy);
+    }
+
+    // Group instance indices by cell; only occupied cells are materialized
+    order.resize(instances.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+        return keys[a] != keys[b] ? keys[a] < keys[b] : a < b;
+    });
+
+    uint32_t begin = 0;
+    while (begin < order.size()) {
+        uint32_t end = begin;
+        uint64_t key = keys[order[begin]];
+        while (end < order.size() && keys[order[end]] == key) ++end;
+
+        uint32_t root = static_cast<uint32_t>(nodes.size());
+        nodes.emplace_back();
+        buildNode(root, begin, end, 0);
+
+        cellRoots.emplace(key, root);
+        cellKeys.push_back(key);
+        begin = end;
+    }
+}
 
-	//Divide to grid cells for optimization
-    double minX = std::min_element(instances.begin(), instances.end(),
-		[](const SpatialInstance& a, const SpatialInstance& b) { return a.x < b.x; })->x;
-	double minY = std::min_element(instances.begin(), instances.end(),
-		[](const SpatialInstance& a, const SpatialInstance& b) { return a.y < b.y; })->y;
-	double maxX = std::max_element(instances.begin(), instances.end(),
-		[](const SpatialInstance& a, const SpatialInstance& b) { return a.x < b.x; })->x;
-	double maxY = std::max_element(instances.begin(), instances.end(),
-		[](const SpatialInstance& a, const SpatialInstance& b) { return a.y < b.y; })->y;
+void SpatialIndex::buildNode(uint32_t node, uint32_t begin, uint32_t end, int depth) {
+    const std::vector<SpatialInstance>& instances = *indexed;
 
-	int gridX = static_cast<int>(std::ceil((maxX - minX) / distanceThreshold));
-	int gridY = static_cast<int>(std::ceil((maxY - minY) / distanceThreshold));
+    // Tight bounding box of the node's instances
+    double minX = instances[order[begin]].x, maxX = minX;
+    double minY = instances[order[begin]].y, maxY = minY;
+    for (uint32_t p = begin + 1; p < end; ++p) {
+        const SpatialInstance& inst = instances[order[p]];
+        minX = std::min(minX, inst.x);
+        maxX = std::max(maxX, inst.x);
+        minY = std::min(minY, inst.y);
+        maxY = std::max(maxY, inst.y);
+    }
+    nodes[node] = {minX, minY, maxX, maxY, begin, end, -1, 0};
+
+    // Sparse nodes stay leaves
+    if (end - begin <= kLeafCapacity || depth >= kMaxDepth) {
+        return;
+    }
 
-	std::vector<std::vector<SpatialInstance>> gridCells(gridX * gridY);
+    // Split dense nodes into quadrants around the center of their bounding box
+    double midX = (minX + maxX) / 2;
+    double midY = (minY + maxY) / 2;
+    auto first = order.begin();
+    auto splitX = std::partition(first + begin, first + end,
+        [&](uint32_t i) { return instances[i].x < midX; });
+    auto splitLow = std::partition(first + begin, splitX,
+        [&](uint32_t i) { return instances[i].y < midY; });
+    auto splitHigh = std::partition(splitX, first + end,
+        [&](uint32_t i) { return instances[i].y < midY; });
 
-    for (const auto& inst : instances) {
-        int cx = static_cast<int>((inst.x - minX) / distanceThreshold);
-        int cy = static_cast<int>((inst.y - minY) / distanceThreshold);
+    uint32_t bounds[5] = {
+        begin,
+        static_cast<uint32_t>(splitLow - first),
+        static_cast<uint32_t>(splitX - first),
+        static_cast<uint32_t>(splitHigh - first),
+        end
+    };
+
+    // Children are allocated consecutively before any of them is expanded
+    uint32_t firstChild = static_cast<uint32_t>(nodes.size());
+    uint32_t childCount = 0;
+    for (int q = 0; q < 4; ++q) {
+        if (bounds[q] < bounds[q + 1]) {
+            nodes.emplace_back();
+            nodes.back().begin = bounds[q];
+            nodes.back().end = bounds[q + 1];
+            ++childCount;
+        }
+    }
+    nodes[node].firstChild = static_cast<int32_t>(firstChild);
+    nodes[node].childCount = childCount;
 
-        gridCells[cx * gridY + cy].push_back(inst);
+    for (uint32_t c = firstChild; c < firstChild + childCount; ++c) {
+        buildNode(c, nodes[c].begin, nodes[c].end, depth + 1);
     }
+}
+
+double SpatialIndex::nodeDist2(const QuadNode& a, const QuadNode& b) {
+    double dx = std::max({0.0, a.minX - b.maxX, b.minX - a.maxX});
+    double dy = std::max({0.0, a.minY - b.maxY, b.minY - a.maxY});
+    return dx * dx + dy * dy;
+}
 
-    for (int cx = 0; cx < gridX; ++cx) {
-        for (int cy = 0; cy < gridY; ++cy) {
+void SpatialIndex::joinNodes(uint32_t a, uint32_t b, bool same,
+                             std::vector<std::pair<SpatialInstance, SpatialInstance>>& pairs) {
+    const QuadNode& nodeA = nodes[a];
+    const QuadNode& nodeB = nodes[b];
 
-            const auto& cell = gridCells[cx * gridY + cy];
+    // Prune node pairs that cannot contain any neighbor pair (small slack for rounding)
+    double limit2 = distanceThreshold * distanceThreshold * (1.0 + 1e-9);
+    if (!same && nodeDist2(nodeA, nodeB) > limit2) {
+        return;
+    }
+
+    bool leafA = nodeA.firstChild < 0;
+    bool leafB = nodeB.firstChild < 0;
+    const std::vector<SpatialInstance>& instances = *indexed;
 
-            // compare between instance in center cell with around cells
-            for (size_t i = 0; i < cell.size(); ++i) {
-				for (size_t j = i + 1; j < cell.size(); ++j) {
-                    if (cell[i].type != cell[j].type && euclideanDist(cell[i], cell[j]) <= distanceThreshold) {
-                        neighborPairs.emplace_back(cell[i], cell[j]);
-                    }
+    // Two leaves: compare their instances directly
+    if (leafA && leafB) {
+        for (uint32_t p = nodeA.begin; p < nodeA.end; ++p) {
+            const SpatialInstance& inst = instances[order[p]];
+            for (uint32_t q = same ? p + 1 : nodeB.begin; q < nodeB.end; ++q) {
+                const SpatialInstance& other = instances[order[q]];
+                if (inst.type != other.type && euclideanDist(inst, other) <= distanceThreshold) {
+                    pairs.emplace_back(inst, other);
                 }
-                for (int dx = 0; dx <= 1; ++dx) {
-                    for (int dy = (dx == 0 ? 1 : -1); dy <= 1; ++dy) {
-                        if (dx == 0 && dy == 0) continue; // skip center cell
-                        int nx = cx + dx;
-                        int ny = cy + dy;
-                        if (nx >= 0 && nx < gridX && ny >= 0 && ny < gridY) {
-                            const auto& neighborCell = gridCells[nx * gridY + ny];
-                            for (const auto& neighborInst : neighborCell) {
-                                if (cell[i].type != neighborInst.type && euclideanDist(cell[i], neighborInst) <= distanceThreshold) {
-                                    neighborPairs.emplace_back(cell[i], neighborInst);
-                                }
-                            }
-                        }
-                    }
-				}
+            }
+        }
+        return;
+    }
+
+    // A node joined with itself: join every unordered pair of its children
+    if (same) {
+        uint32_t end = nodeA.firstChild + nodeA.childCount;
+        for (uint32_t c = nodeA.firstChild; c < end; ++c) {
+            for (uint32_t o = c; o < end; ++o) {
+                joinNodes(c, o, c == o, pairs);
+            }
+        }
+        return;
+    }
+
+    // Otherwise descend into the larger of the two inner nodes
+    if (!leafA && (leafB || nodeA.end - nodeA.begin >= nodeB.end - nodeB.begin)) {
+        for (uint32_t c = nodeA.firstChild; c < nodeA.firstChild + nodeA.childCount; ++c) {
+            joinNodes(c, b, false, pairs);
+        }
+    } else {
+        for (uint32_t c = nodeB.firstChild; c < nodeB.firstChild + nodeB.childCount; ++c) {
+            joinNodes(a, c, false, pairs);
+        }
+    }
+}
+
+std::vector<std::pair<SpatialInstance, SpatialInstance>> SpatialIndex::findNeighborPair(const std::vector<SpatialInstance>& instances) {
+    std::vector<std::pair<SpatialInstance, SpatialInstance>> neighborPairs;
+    if (instances.empty()) {
+        return neighborPairs;
+    }
+
+    build(instances);
+
+    // Forward half of the 8-neighborhood, so every pair of cells is joined once
+    static const int forward[4][2] = { {1, -1}, {1, 0}, {1, 1}, {0, 1} };
+
+    for (uint64_t key : cellKeys) {
+        int64_t cx = static_cast<int32_t>(key >> 32);
+        int64_t cy = static_cast<int32_t>(key & 0xffffffffu);
+        uint32_t root = cellRoots[key];
+
+        // compare between instance in center cell with around cells
+        joinNodes(root, root, true, neighborPairs);
+        for (const auto& offset : forward) {
+            auto it = cellRoots.find(cellKey(cx + offset[0], cy + offset[1]));
+            if (it != cellRoots.end()) {
+                joinNodes(root, it->second, false, neighborPairs);
             }
         }
     }
+
     for (auto& p : neighborPairs) {
         bool needSwap = false;
 
@@ -94,4 +225,160 @@ std::vector<std::pair<SpatialInstance, SpatialInstance>> SpatialIndex::findNeigh
     }
 
     return neighborPairs;
-}
\ No newline at end of file
+}
+
+void SpatialIndex::queryNode(uint32_t node, const SpatialInstance& center, std::vector<uint32_t>& out) const {
+    const QuadNode& n = nodes[node];
+
+    // Prune nodes whose bounding box is out of reach (small slack for rounding)
+    double dx = std::max({0.0, n.minX - center.x, center.x - n.maxX});
+    double dy = std::max({0.0, n.minY - center.y, center.y - n.maxY});
+    if (dx * dx + dy * dy > distanceThreshold * distanceThreshold * (1.0 + 1e-9)) {
+        return;
+    }
+
+    if (n.firstChild >= 0) {
+        for (uint32_t c = n.firstChild; c < n.firstChild + n.childCount; ++c) {
+            queryNode(c, center, out);
+        }
+        return;
+    }
+
+    const std::vector<SpatialInstance>& instances = *indexed;
+    for (uint32_t p = n.begin; p < n.end; ++p) {
+        const SpatialInstance& other = instances[order[p]];
+        if (other.feature > center.feature && euclideanDist(center, other) <= distanceThreshold) {
+            out.push_back(order[p]);
+        }
+    }
+}
+
+void SpatialIndex::queryBoxNode(uint32_t node, double minX, double minY, double maxX, double maxY,
+                                std::vector<uint32_t>& out) const {
+    const QuadNode& n = nodes[node];
+    if (n.maxX < minX || n.minX > maxX || n.maxY < minY || n.minY > maxY) {
+        return;
+    }
+
+    // A node inside the rectangle is taken whole
+    bool inside = n.minX >= minX && n.maxX <= maxX && n.minY >= minY && n.maxY <= maxY;
+    if (inside) {
+        out.insert(out.end(), order.begin() + n.begin, order.begin() + n.end);
+        return;
+    }
+
+    if (n.firstChild >= 0) {
+        for (uint32_t c = n.firstChild; c < n.firstChild + n.childCount; ++c) {
+            queryBoxNode(c, minX, minY, maxX, maxY, out);
+        }
+        return;
+    }
+
+    const std::vector<SpatialInstance>& instances = *indexed;
+    for (uint32_t p = n.begin; p < n.end; ++p) {
+        const SpatialInstance& inst = instances[order[p]];
+        if (inst.x >= minX && inst.x <= maxX && inst.y >= minY && inst.y <= maxY) {
+            out.push_back(order[p]);
+        }
+    }
+}
+
+void SpatialIndex::queryBox(double minX, double minY, double maxX, double maxY,
+                            std::vector<uint32_t>& out) const {
+    if (indexed == nullptr) {
+        throw std::logic_error("SpatialIndex::queryBox called before the index was built");
+    }
+    out.clear();
+    if (minX > maxX || minY > maxY) {
+        return;
+    }
+
+    // Visit the overlapped cells by coordinates, or scan the occupied cells when
+    // the rectangle spans more cells than are occupied
+    double x0 = std::floor(minX / distanceThreshold), x1 = std::floor(maxX / distanceThreshold);
+    double y0 = std::floor(minY / distanceThreshold), y1 = std::floor(maxY / distanceThreshold);
+    if ((x1 - x0 + 1) * (y1 - y0 + 1) <= static_cast<double>(cellKeys.size())) {
+        for (int64_t cx = static_cast<int64_t>(x0); cx <= static_cast<int64_t>(x1); ++cx) {
+            for (int64_t cy = static_cast<int64_t>(y0); cy <= static_cast<int64_t>(y1); ++cy) {
+                auto it = cellRoots.find(cellKey(cx, cy));
+                if (it != cellRoots.end()) {
+                    queryBoxNode(it->second, minX, minY, maxX, maxY, out);
+                }
+            }
+        }
+    } else {
+        for (uint64_t key : cellKeys) {
+            queryBoxNode(cellRoots.at(key), minX, minY, maxX, maxY, out);
+        }
+    }
+
+    std::sort(out.begin(), out.end());
+}
+
+void SpatialIndex::collectStarNeighbors(uint32_t center, std::vector<uint32_t>& out) const {
+    const std::vector<SpatialInstance>& instances = *indexed;
+    const SpatialInstance& inst = instances[center];
+    out.clear();
+
+    // Neighbors can only lie in the center's cell or the 8 cells around it
+    int64_t cx = static_cast<int64_t>(std::floor(inst.x / distanceThreshold));
+    int64_t cy = static_cast<int64_t>(std::floor(inst.y / distanceThreshold));
+    for (int64_t dx = -1; dx <= 1; ++dx) {
+        for (int64_t dy = -1; dy <= 1; ++dy) {
+            auto it = cellRoots.find(cellKey(cx + dx, cy + dy));
+            if (it != cellRoots.end()) {
+                queryNode(it->second, inst, out);
+            }
+        }
+    }
+
+    std::sort(out.begin(), out.end(), [&](uint32_t a, uint32_t b) {
+        return instances[a].feature != instances[b].feature
+            ? instances[a].feature < instances[b].feature
+            : a < b;
+    });
+}
+
+void SpatialIndex::findStarNeighbors(const std::vector<SpatialInstance>& instances,
+                                     std::vector<size_t>& offsets,
+                                     std::vector<uint32_t>& neighbors) {
+    offsets.assign(instances.size() + 1, 0);
+    neighbors.clear();
+    if (instances.empty()) {
+        return;
+    }
+
+    build(instances);
+    int64_t numInstances = static_cast<int64_t>(instances.size());
+
+    // One scan per center: blocks of consecutive centers are searched in
+    // parallel, each into its own buffer, while the counts go straight to offsets
+    const int64_t blockSize = 1024;
+    int64_t numBlocks = (numInstances + blockSize - 1) / blockSize;
+    std::vector<std::vector<uint32_t>> blockNeighbors(numBlocks);
+
+    #pragma omp parallel
+    {
+        std::vector<uint32_t> scratch;
+        #pragma omp for schedule(dynamic, 1)
+        for (int64_t block = 0; block < numBlocks; ++block) {
+            std::vector<uint32_t>& out = blockNeighbors[block];
+            int64_t end = std::min(numInstances, (block + 1) * blockSize);
+            for (int64_t i = block * blockSize; i < end; ++i) {
+                collectStarNeighbors(static_cast<uint32_t>(i), scratch);
+                offsets[i + 1] = scratch.size();
+                out.insert(out.end(), scratch.begin(), scratch.end());
+            }
+        }
+    }
+    std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+
+    // Copy each block's run to its final position, freeing the buffers as it goes
+    neighbors.resize(offsets.back());
+    #pragma omp parallel for schedule(dynamic, 1)
+    for (int64_t block = 0; block < numBlocks; ++block) {
+        std::vector<uint32_t>& out = blockNeighbors[block];
+        std::copy(out.begin(), out.end(), neighbors.begin() + offsets[block * blockSize]);
+        std::vector<uint32_t>().swap(out);
+    }
+}
@@ -0,0 +1,92 @@
+/**
+ * @file spatial_order.cpp
+ * @brief Implementation of space-filling-curve reordering
+ */
+
+#include "spatial_order.h"
+#include "radix_sort.h"
+#include <algorithm>
+#include <stdexcept>
+#include <omp.h>
+
+namespace {
+
+// Spread the 16 low bits of v so that bit i moves to bit 2i
+uint32_t spreadBits(uint32_t v) {
+    v &= 0x0000ffff;
+    v = (v | (v << 8)) & 0x00ff00ff;
+    v = (v | (v << 4)) & 0x0f0f0f0f;
+    v = (v | (v << 2)) & 0x33333333;
+    v = (v | (v << 1)) & 0x55555555;
+    return v;
+}
+
+uint32_t mortonKey(uint32_t x, uint32_t y) {
+    return spreadBits(x) | (spreadBits(y) << 1);
+}
+
+// Distance along a Hilbert curve filling a 65536 x 65536 grid
+uint32_t hilbertKey(uint32_t x, uint32_t y) {
+    uint32_t d = 0;
+    for (uint32_t s = 1u << 15; s > 0; s >>= 1) {
+        uint32_t rx = (x & s) ? 1 : 0;
+        uint32_t ry = (y & s) ? 1 : 0;
+        d += s * s * ((3 * rx) ^ ry);
+
+        // Rotate the quadrant so the curve stays continuous
+        if (ry == 0) {
+            if (rx == 1) {
+                x = s - 1 - x;
+                y = s - 1 - y;
+            }
+            std::swap(x, y);
+        }
+    }
+    return d;
+}
+
+} // namespace
+
+SpatialOrder parseSpatialOrder(const std::string& name) {
+    if (name == "morton") return SpatialOrder::Morton;
+    if (name == "hilbert") return SpatialOrder::Hilbert;
+    if (name == "none") return SpatialOrder::None;
+    throw std::invalid_argument("spatial_order must be none, morton or hilbert, not '" + name + "'");
+}
+
+void reorderInstances(std::vector<SpatialInstance>& instances, SpatialOrder order) {
+    if (order == SpatialOrder::None || instances.size() < 2) {
+        return;
+    }
+
+    auto xRange = std::minmax_element(instances.begin(), instances.end(),
+        [](const SpatialInstance& a, const SpatialInstance& b) { return a.x < b.x; });
+    auto yRange = std::minmax_element(instances.begin(), instances.end(),
+        [](const SpatialInstance& a, const SpatialInstance& b) { return a.y < b.y; });
+    double minX = xRange.first->x, spanX = xRange.second->x - minX;
+    double minY = yRange.first->y, spanY = yRange.second->y - minY;
+    double scaleX = spanX > 0 ? 65535.0 / spanX : 0.0;
+    double scaleY = spanY > 0 ? 65535.0 / spanY : 0.0;
+
+    // Quantize coordinates and compute curve keys
+    const int64_t n = static_cast<int64_t>(instances.size());
+    std::vector<uint32_t> keys(instances.size());
+    std::vector<uint32_t> perm(instances.size());
+    #pragma omp parallel for
+    for (int64_t i = 0; i < n; ++i) {
+        uint32_t qx = static_cast<uint32_t>((instances[i].x - minX) * scaleX);
+        uint32_t qy = static_cast<uint32_t>((instances[i].y - minY) * scaleY);
+        keys[i] = (order == SpatialOrder::Hilbert) ? hilbertKey(qx, qy) : mortonKey(qx, qy);
+        perm[i] = static_cast<uint32_t>(i);
+    }
+
+    radixSortPairs(keys, perm);
+
+    // Move instances to their new positions
+    std::vector<SpatialInstance> sorted(instances.size());
+    #pragma omp parallel for
+    for (int64_t i = 0; i < n; ++i) {
+        sorted[i] = std::move(instances[perm[i]]);
+    }
+    instances.swap(sorted);
+}
@@ -0,0 +1,76 @@
+/**
+ * @file star_enumerator.cpp
+ * @brief Implementation of the iterative star instance enumerator
+ */
+
+#include "star_enumerator.h"
+
+bool StarEnumerator::bind(const StarNeighborhood& s, const Pattern& pattern) {
+    star = &s;
+    width = pattern.size();
+    rangeBegin.resize(width);
+    rangeEnd.resize(width);
+    cursor.resize(width);
+
+    // Slot 0 is the center itself; every other slot needs at least one neighbor
+    for (size_t slot = 1; slot < width; ++slot) {
+        const NeighborGroup* group = s.findGroup(pattern[slot]);
+        if (group == nullptr) {
+            return false;
+        }
+        rangeBegin[slot] = group->begin;
+        rangeEnd[slot] = group->end;
+    }
+    return true;
+}
+
+uint64_t StarEnumerator::count() const {
+    uint64_t total = 1;
+    for (size_t slot = 1; slot < width; ++slot) {
+        total *= rangeEnd[slot] - rangeBegin[slot];
+    }
+    return total;
+}
+
+template <size_t K>
+size_t StarEnumerator::emitRows(std::vector<const SpatialInstance*>& out) {
+    const size_t k = K ? K : width;
+    size_t rows = static_cast<size_t>(count());
+    size_t offset = out.size();
+    out.resize(offset + rows * k);
+    const SpatialInstance** dst = out.data() + offset;
+    const SpatialInstance* const* neighbors = star->neighbors.data();
+
+    for (size_t slot = 1; slot < k; ++slot) {
+        cursor[slot] = rangeBegin[slot];
+    }
+
+    for (size_t r = 0; r < rows; ++r) {
+        *dst++ = star->center;
+        for (size_t slot = 1; slot < k; ++slot) {
+            *dst++ = neighbors[cursor[slot]];
+        }
+
+        // Advance the odometer: the last slot turns fastest
+        for (size_t slot = k - 1; slot > 0; --slot) {
+            if (++cursor[slot] < rangeEnd[slot]) break;
+            cursor[slot] = rangeBegin[slot];
+        }
+    }
+    return rows;
+}
+
+size_t StarEnumerator::emit(std::vector<const SpatialInstance*>& out) {
+    return dispatchPatternSize(width, [&](auto fixed) {
+        return emitRows<decltype(fixed)::value>(out);
+    });
+}
+
+void StarEnumerator::markParticipants(ParticipationBitmap* slots) const {
+    slots[0].set(star->center->featureIndex);
+    for (size_t slot = 1; slot < width; ++slot) {
+        for (uint32_t n = rangeBegin[slot]; n < rangeEnd[slot]; ++n) {
+            slots[slot].set(star->neighbors[n]->featureIndex);
+        }
+    }
+}
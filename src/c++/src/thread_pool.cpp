@@ -0,0 +1,54 @@
+/**
+ * @file thread_pool.cpp
+ * @brief Implementation of the worker thread pool
+ */
+
+#include "thread_pool.h"
+#include <algorithm>
+
+ThreadPool::ThreadPool(size_t threads) {
+    threads = std::max<size_t>(1, threads);
+    for (size_t t = 0; t < threads; ++t) {
+        workers.emplace_back([this] { workerLoop(); });
+    }
+}
+
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wakeup.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+
+void ThreadPool::submit(std::function<void()> task) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        tasks.push_back(std::move(task));
+    }
+    wakeup.notify_one();
+}
+
+
+void ThreadPool::workerLoop() {
+    for (;;) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wakeup.wait(lock, [this] { return stopping || !tasks.empty(); });
+            if (tasks.empty()) return;
+            task = std::move(tasks.front());
+            tasks.pop_front();
+        }
+        try {
+            task();
+        } catch (...) {
+            // A failed task must not take the worker down
+        }
+    }
+}
@@ -0,0 +1,112 @@
+/**
+ * @file tile_worker.cpp
+ * @brief Implementation of the per-tile participant search
+ */
+
+#include "tile_worker.h"
+#include "spatial_index.h"
+
+TileWorker::TileWorker(std::vector<SpatialInstance> tileInstances, std::vector<char> ownedFlags,
+                       double distance, size_t numFeatures)
+    : instances(std::move(tileInstances)),
+      owned(std::move(ownedFlags)),
+      localSizes(numFeatures, 0),
+      starsByFeature(numFeatures, nullptr)
+{
+    // Dataset order is kept, so renumbering preserves the order within each feature
+    globalIndex.resize(numFeatures);
+    for (auto& instance : instances) {
+        globalIndex[instance.feature].push_back(instance.featureIndex);
+        instance.featureIndex = static_cast<uint32_t>(localSizes[instance.feature]++);
+    }
+
+    SpatialIndex index(distance);
+    neighborhoods.buildFromIndex(instances, index);
+
+    for (const auto& entry : neighborhoods.getAllStarNeighborhoods()) {
+        if (!entry.second.empty()) {
+            starsByFeature[entry.second.front().center->feature] = &entry.second;
+        }
+    }
+}
+
+
+bool TileWorker::markCliques(const Pattern& pattern, const NeighborGroup* const* groups,
+                             const StarNeighborhood& star, size_t depth,
+                             const SpatialInstance** chosen, ParticipationBitmap* slots) const {
+    if (depth == pattern.size()) {
+        for (size_t slot = 1; slot < depth; ++slot) {
+            slots[slot].set(chosen[slot]->featureIndex);
+        }
+        return true;
+    }
+
+    bool found = false;
+    const NeighborGroup* group = groups[depth];
+    for (uint32_t n = group->begin; n < group->end; ++n) {
+        const SpatialInstance* candidate = star.neighbors[n];
+
+        // Every member is a star neighbor of the center; check the other edges
+        bool clique = true;
+        for (size_t slot = 1; slot < depth && clique; ++slot) {
+            clique = neighborhoods.areNeighbors(chosen[slot], candidate);
+        }
+        if (!clique) continue;
+
+        chosen[depth] = candidate;
+        found |= markCliques(pattern, groups, star, depth + 1, chosen, slots);
+    }
+    return found;
+}
+
+
+void TileWorker::collectParticipants(const Pattern& pattern,
+                                     std::vector<std::vector<uint32_t>>& participants) const {
+    size_t k = pattern.size();
+    const std::vector<StarNeighborhood>* stars = starsByFeature[pattern[0]];
+    if (stars == nullptr) return;
+
+    std::vector<ParticipationBitmap> slots(k);
+    for (size_t slot = 0; slot < k; ++slot) {
+        slots[slot].reset(localSizes[pattern[slot]]);
+    }
+
+    // Stars lacking a feature are skipped by mask when every code fits in one
+    FeatureMask required;
+    bool useMask = true;
+    for (size_t slot = 1; slot < k; ++slot) {
+        required.set(pattern[slot]);
+        useMask &= pattern[slot] < FeatureMask::kCapacity;
+    }
+
+    const NeighborGroup* groups[kMaxPatternSize];
+    const SpatialInstance* chosen[kMaxPatternSize];
+    for (const auto& star : *stars) {
+        // Only cliques centered in the core belong to this tile
+        if (!owned[star.center - instances.data()]) continue;
+        if (useMask && !star.presence.contains(required)) continue;
+
+        bool complete = true;
+        for (size_t slot = 1; slot < k && complete; ++slot) {
+            groups[slot] = star.findGroup(pattern[slot]);
+            complete = groups[slot] != nullptr;
+        }
+        if (!complete) continue;
+
+        chosen[0] = star.center;
+        if (markCliques(pattern, groups, star, 1, chosen, slots.data())) {
+            slots[0].set(star.center->featureIndex);
+        }
+    }
+
+    // Translate tile-local feature indices back to the dataset's
+    participants.resize(k);
+    for (size_t slot = 0; slot < k; ++slot) {
+        const std::vector<uint32_t>& toGlobal = globalIndex[pattern[slot]];
+        for (uint32_t local = 0; local < toGlobal.size() && slots[slot].count > 0; ++local) {
+            if (slots[slot].test(local)) {
+                participants[slot].push_back(toGlobal[local]);
+            }
+        }
+    }
+}
@@ -4,14 +4,18 @@
  */
 
 #include "utils.h"
+#include <algorithm>
 #include <set>
 #include <chrono>
-#include <windows.h>
-#include <psapi.h>
 #include <iostream> 
 #include <iomanip>
+#ifdef _WIN32
 #include <windows.h>
 #include <psapi.h>
+#else
+#include <fstream>
+#include <unistd.h>
+#endif
 
 // Get all unique feature types from instances
 std::vector<FeatureType> getAllObjectTypes(const std::vector<SpatialInstance>& instances) {
@@ -27,6 +31,20 @@ std::vector<FeatureType> getAllObjectTypes(const std::vector<SpatialInstance>& i
     return std::vector<FeatureType>(objectTypesSet.begin(), objectTypesSet.end());
 }
 
+// Assign dense feature codes following the sorted order of feature types
+std::vector<FeatureType> assignFeatureCodes(std::vector<SpatialInstance>& instances) {
+    std::vector<FeatureType> types = getAllObjectTypes(instances);
+    std::vector<uint32_t> nextIndex(types.size(), 0);
+
+    for (auto& instance : instances) {
+        auto it = std::lower_bound(types.begin(), types.end(), instance.type);
+        instance.feature = static_cast<FeatureCode>(it - types.begin());
+        instance.featureIndex = nextIndex[instance.feature]++;
+    }
+
+    return types;
+}
+
 // Count the number of instances for each feature type
 std::map<FeatureType, int> countInstancesByFeature(const std::vector<SpatialInstance>& instances) {
     std::map<FeatureType, int> featureCount;
@@ -59,31 +77,6 @@ SpatialInstance getInstanceByID(
 }
 
 
-void findCombinations(
-    const std::vector<FeatureType>& candidatePattern,
-    int typeIndex,
-    std::vector<const SpatialInstance*>& currentInstance,
-    const std::unordered_map<FeatureType, std::vector<const SpatialInstance*>>& neighborMap,
-    std::vector<ColocationInstance>& results) 
-{
-    // Base case: if we've matched all types in the candidate pattern
-    if (typeIndex >= candidatePattern.size()) {
-        results.push_back(currentInstance);
-        return;
-    }
-    FeatureType currentType = candidatePattern[typeIndex];
-
-    auto it = neighborMap.find(currentType);
-    if (it != neighborMap.end()) {
-        for (const auto* neighbor : it->second) {
-            currentInstance.push_back(neighbor);
-            findCombinations(candidatePattern, typeIndex + 1, currentInstance, neighborMap, results);
-            currentInstance.pop_back();
-        }
-    }
-}
-
-
 void printDuration(const std::string& stepName, std::chrono::high_resolution_clock::time_point start, std::chrono::high_resolution_clock::time_point end) {
     auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
     std::cout << "[PERF] " << stepName << ": " << duration << " ms" << std::endl;
@@ -91,9 +84,39 @@ void printDuration(const std::string& stepName, std::chrono::high_resolution_clo
 
 
 double getMemoryUsageMB() {
+#ifdef _WIN32
     PROCESS_MEMORY_COUNTERS pmc;
     if (GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc))) {
         return static_cast<double>(pmc.WorkingSetSize) / (1024.0 * 1024.0);
     }
+#else
+    // Resident pages from /proc (Linux)
+    std::ifstream statm("/proc/self/statm");
+    size_t totalPages = 0;
+    size_t residentPages = 0;
+    if (statm >> totalPages >> residentPages) {
+        return static_cast<double>(residentPages) * sysconf(_SC_PAGESIZE) / (1024.0 * 1024.0);
+    }
+#endif
+    return 0.0;
+}
+
+
+double getPeakMemoryUsageMB() {
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS pmc;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc))) {
+        return static_cast<double>(pmc.PeakWorkingSetSize) / (1024.0 * 1024.0);
+    }
+#else
+    // High-water mark of the resident set, in kB (Linux)
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line)) {
+        if (line.compare(0, 6, "VmHWM:") == 0) {
+            return std::stod(line.substr(6)) / 1024.0;
+        }
+    }
+#endif
     return 0.0;
 }
\ No newline at end of file
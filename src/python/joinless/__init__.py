@@ -9,3 +9,14 @@ from .structures import (
 )
 from .data_loader import load_spatial_dataset, load_or_build_dataset
 from .mining import mine_colocation_patterns
+
+# The native bindings need NumPy; import them on first use so the loaders work without it
+_NATIVE_NAMES = ("NativeSession", "NativePatterns", "mine_arrays", "mine_dataframe")
+
+
+def __getattr__(name):
+    if name in _NATIVE_NAMES:
+        from . import native
+
+        return getattr(native, name)
+    raise AttributeError(f"module {__name__!r} has no attribute {name!r}")
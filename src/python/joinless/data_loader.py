@@ -1,4 +1,3 @@
-import pandas as pd
 import os
 from .structures import SpatialDataset, SpatialInstance
 
@@ -7,16 +6,25 @@ def load_spatial_dataset(csv_path: str) -> SpatialDataset:
     """
     Load the LasVegas dataset from CSV into SpatialDataset structure.
     """
+    import pandas as pd
+
     df = pd.read_csv(csv_path)
     dataset = SpatialDataset()
 
-    for _, row in df.iterrows():
+    columns = zip(
+        df["Feature"].astype(str),
+        df["Instance"].astype(int),
+        df["LocX"].astype(float),
+        df["LocY"].astype(float),
+        df["Checkin"].astype(int),
+    )
+    for feature, instance_id, x, y, checkin in columns:
         instance = SpatialInstance(
-            feature=str(row["Feature"]),
-            instance_id=int(row["Instance"]),
-            x=float(row["LocX"]),
-            y=float(row["LocY"]),
-            checkin=int(row["Checkin"]),
+            feature=feature,
+            instance_id=int(instance_id),
+            x=float(x),
+            y=float(y),
+            checkin=int(checkin),
         )
         dataset.add_instance(instance)
 
@@ -26,40 +34,40 @@ def load_spatial_dataset(csv_path: str) -> SpatialDataset:
 def load_or_build_dataset(
     csv_path: str,
     cache_path: str,
-    distance_threshold: float,
+    distance_threshold: float = 0.0,
     force_rebuild: bool = False,
 ) -> SpatialDataset:
     """
     Load dataset from cache if available, otherwise build from CSV.
+    Only the instances are cached: neighbor relations and star neighborhoods are
+    built by the native miner, so the cache does not depend on the threshold.
 
     Args:
         csv_path: Path to CSV file
         cache_path: Path to pickle cache file
-        distance_threshold: Distance threshold for neighbor relations
+        distance_threshold: Neighbor distance recorded on the dataset (not used to build anything)
         force_rebuild: If True, rebuild even if cache exists
 
     Returns:
-        SpatialDataset with precomputed star neighborhoods
+        SpatialDataset with its instances and features
     """
     if not force_rebuild and os.path.exists(cache_path):
         print("Loading from cache...")
         dataset = SpatialDataset.load_from_file(cache_path)
 
-        # Check if threshold matches
-        if dataset.distance_threshold == distance_threshold:
-            print(
-                f"Loaded {len(dataset.instances)} instances, {len(dataset.star_neighborhoods)} star neighborhoods"
-            )
-            return dataset
-        else:
-            print(
-                f"Threshold mismatch. Rebuilding with threshold={distance_threshold}..."
-            )
+        # Caches written by older versions also hold the Python neighbor graph
+        if dataset.neighbor_relations or dataset.star_neighborhoods:
+            dataset.neighbor_relations.clear()
+            dataset.star_neighborhoods.clear()
+            dataset.save_to_file(cache_path)
+
+        dataset.distance_threshold = distance_threshold
+        print(f"Loaded {len(dataset.instances)} instances")
+        return dataset
 
     print("Building dataset from CSV...")
     dataset = load_spatial_dataset(csv_path)
-    dataset.build_neighbor_relations(threshold=distance_threshold)
-    dataset.build_star_neighborhoods()
     dataset.save_to_file(cache_path)
     print("Dataset cached successfully.")
+    dataset.distance_threshold = distance_threshold
     return dataset
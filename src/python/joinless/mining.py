@@ -1,12 +1,34 @@
-# TODO: Implement the main Joinless Co-location Mining algorithm here.
-# This file is currently a placeholder.
-# Refer to structures.py for data structures.
-
 from .structures import SpatialDataset, ColocationPattern
 
-def mine_colocation_patterns(dataset: SpatialDataset, min_prevalence: float) -> list[ColocationPattern]:
+
+def mine_colocation_patterns(
+    dataset: SpatialDataset, distance_threshold: float, min_prevalence: float
+) -> list[ColocationPattern]:
     """
     Main function to mine colocation patterns using the Joinless algorithm.
+    Runs the native C++ miner on the dataset's instances at the given neighbor
+    distance, so the Python neighbor relations and star neighborhoods are not needed.
     """
-    # TODO: Implement algorithm
-    pass
+    import numpy as np
+
+    from .native import NativeSession
+
+    names = sorted(dataset.features)
+    code_of = {name: code for code, name in enumerate(names)}
+    count = len(dataset.instances)
+
+    session = NativeSession()
+    session.load(
+        np.fromiter((inst.x for inst in dataset.instances), dtype=np.float64, count=count),
+        np.fromiter((inst.y for inst in dataset.instances), dtype=np.float64, count=count),
+        np.fromiter((code_of[inst.feature] for inst in dataset.instances), dtype=np.int32, count=count),
+        names,
+        instance_numbers=np.fromiter((inst.instance_id for inst in dataset.instances), dtype=np.int64, count=count),
+        order="hilbert",
+    )
+    session.build_graph(distance_threshold)
+    result = session.mine(min_prevalence)
+    return [
+        ColocationPattern(features=features, participation=float(index))
+        for features, index in zip(result.patterns(), result.participation)
+    ]
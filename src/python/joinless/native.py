@@ -0,0 +1,289 @@
+"""
+Native bindings to the C++ joinless library (libjoinless) through its C API.
+
+Coordinates and feature codes are handed to the library as NumPy buffers without
+copying (arrays that are already contiguous and of the right dtype are passed as
+they are). Calls into the library go through ctypes, which releases the GIL for
+their whole duration, so neighbor search and mining run in parallel with other
+Python threads.
+
+The library is looked up in the JOINLESS_LIBRARY environment variable, then in
+the usual CMake build directories of the repository, then on the system path.
+Build it with:  cmake -S . -B build -DJOINLESS_SHARED=ON && cmake --build build --target joinless
+"""
+
+import ctypes
+import ctypes.util
+import os
+from dataclasses import dataclass
+from typing import List, Optional, Sequence, Tuple
+
+import numpy as np
+
+_STATUS_OK = 0
+_STRATEGIES = {"levelwise": 0, "depthfirst": 1}
+_ORDERS = {"none": 0, "morton": 1, "hilbert": 2}
+
+_LIBRARY_NAMES = ("libjoinless.so", "libjoinless.dylib", "joinless.dll")
+
+
+# 1. C API DECLARATIONS
+class _Options(ctypes.Structure):
+    """Mirror of joinless_options (joinless.h)."""
+
+    _fields_ = [
+        ("struct_size", ctypes.c_size_t),
+        ("min_prevalence", ctypes.c_double),
+        ("strategy", ctypes.c_int),
+        ("memory_budget", ctypes.c_size_t),
+        ("spill_dir", ctypes.c_char_p),
+        ("participation", ctypes.c_int),
+    ]
+
+
+def _find_library() -> str:
+    """Locate the shared joinless library."""
+    override = os.environ.get("JOINLESS_LIBRARY")
+    if override:
+        return override
+
+    repo_root = os.path.dirname(os.path.dirname(os.path.dirname(os.path.dirname(os.path.abspath(__file__)))))
+    for build_dir in ("build", "out/build", "_build"):
+        for name in _LIBRARY_NAMES:
+            candidate = os.path.join(repo_root, build_dir, name)
+            if os.path.exists(candidate):
+                return candidate
+
+    found = ctypes.util.find_library("joinless")
+    if found is None:
+        raise OSError(
+            "libjoinless not found: build it with -DJOINLESS_SHARED=ON or set JOINLESS_LIBRARY"
+        )
+    return found
+
+
+def _declare(lib: ctypes.CDLL) -> ctypes.CDLL:
+    """Attach argument and return types to the C API functions."""
+    c_double_p = ctypes.POINTER(ctypes.c_double)
+    c_int32_p = ctypes.POINTER(ctypes.c_int32)
+    c_int64_p = ctypes.POINTER(ctypes.c_int64)
+
+    lib.joinless_api_version.restype = ctypes.c_int
+    lib.joinless_last_error.restype = ctypes.c_char_p
+    lib.joinless_options_init.argtypes = [ctypes.POINTER(_Options)]
+    lib.joinless_session_create.restype = ctypes.c_void_p
+    lib.joinless_session_free.argtypes = [ctypes.c_void_p]
+    lib.joinless_session_load.argtypes = [
+        ctypes.c_void_p, c_int32_p, c_double_p, c_double_p, c_int64_p,
+        ctypes.c_size_t, ctypes.POINTER(ctypes.c_char_p), ctypes.c_size_t, ctypes.c_int,
+    ]
+    lib.joinless_session_size.argtypes = [ctypes.c_void_p]
+    lib.joinless_session_size.restype = ctypes.c_size_t
+    lib.joinless_session_build_graph.argtypes = [ctypes.c_void_p, ctypes.c_double]
+    lib.joinless_session_mine.argtypes = [
+        ctypes.c_void_p, ctypes.POINTER(_Options), ctypes.POINTER(ctypes.c_void_p)
+    ]
+    lib.joinless_result_count.argtypes = [ctypes.c_void_p]
+    lib.joinless_result_count.restype = ctypes.c_size_t
+    lib.joinless_result_total_features.argtypes = [ctypes.c_void_p]
+    lib.joinless_result_total_features.restype = ctypes.c_size_t
+    lib.joinless_result_export.argtypes = [ctypes.c_void_p, c_int64_p, c_int32_p, c_double_p]
+    lib.joinless_result_free.argtypes = [ctypes.c_void_p]
+    return lib
+
+
+_lib: Optional[ctypes.CDLL] = None
+
+
+def _library() -> ctypes.CDLL:
+    """Load the library on first use."""
+    global _lib
+    if _lib is None:
+        _lib = _declare(ctypes.CDLL(_find_library()))
+    return _lib
+
+
+def _check(status: int):
+    """Raise the library's last error for a failed call."""
+    if status != _STATUS_OK:
+        message = _library().joinless_last_error().decode("utf-8", "replace")
+        raise ValueError(message) if status == 1 else RuntimeError(message)
+
+
+def _buffer(array: np.ndarray, ctype):
+    """Pointer to a NumPy buffer (the array must stay referenced during the call)."""
+    return array.ctypes.data_as(ctypes.POINTER(ctype))
+
+
+# 2. RESULTS
+@dataclass
+class NativePatterns:
+    """
+    Mined patterns as flat arrays (the layout of an Arrow list array).
+    Pattern i is feature_codes[offsets[i]:offsets[i + 1]]; codes index feature_names.
+    """
+
+    offsets: np.ndarray  # int64, one more entry than there are patterns
+    feature_codes: np.ndarray  # int32, features of every pattern back to back
+    participation: np.ndarray  # float64 participation index per pattern (NaN if not computed)
+    feature_names: List[str]  # Names of the feature codes, as passed to load()
+
+    def __len__(self) -> int:
+        return len(self.offsets) - 1
+
+    def patterns(self) -> List[Tuple[str, ...]]:
+        """Patterns as tuples of feature names."""
+        return [
+            tuple(self.feature_names[c] for c in self.feature_codes[self.offsets[i]:self.offsets[i + 1]])
+            for i in range(len(self))
+        ]
+
+    def to_arrow(self):
+        """Patterns as a pyarrow Table (features: list<string>, participation_index: double)."""
+        import pyarrow as pa
+
+        values = pa.DictionaryArray.from_arrays(
+            pa.array(self.feature_codes), pa.array(self.feature_names, type=pa.string())
+        ).dictionary_decode()
+        features = pa.LargeListArray.from_arrays(pa.array(self.offsets), values)
+        return pa.table({"features": features, "participation_index": self.participation})
+
+
+# 3. SESSION
+class NativeSession:
+    """
+    A dataset and its neighbor graph held by the C++ library.
+    Load instances once, build the graph once per distance, then mine repeatedly.
+    """
+
+    def __init__(self):
+        self._lib = _library()
+        self._handle = self._lib.joinless_session_create()
+        if not self._handle:
+            raise MemoryError(self._lib.joinless_last_error().decode())
+        self._feature_names: List[str] = []
+
+    def __del__(self):
+        handle = getattr(self, "_handle", None)
+        if handle:
+            self._lib.joinless_session_free(handle)
+            self._handle = None
+
+    def __len__(self) -> int:
+        return self._lib.joinless_session_size(self._handle)
+
+    def load(
+        self,
+        x: np.ndarray,
+        y: np.ndarray,
+        feature_codes: np.ndarray,
+        feature_names: Sequence[str],
+        instance_numbers: Optional[np.ndarray] = None,
+        order: str = "none",
+    ):
+        """
+        Load instances from arrays: x, y (float64), feature_codes (int32 indexes
+        into feature_names) and optional instance_numbers (int64, used in instance
+        IDs). Arrays of these dtypes that are C-contiguous are not copied.
+        """
+        x = np.ascontiguousarray(x, dtype=np.float64)
+        y = np.ascontiguousarray(y, dtype=np.float64)
+        codes = np.ascontiguousarray(feature_codes, dtype=np.int32)
+        if not (len(x) == len(y) == len(codes)):
+            raise ValueError("x, y and feature_codes must have the same length")
+        numbers = None
+        if instance_numbers is not None:
+            numbers = np.ascontiguousarray(instance_numbers, dtype=np.int64)
+            if len(numbers) != len(x):
+                raise ValueError("instance_numbers must have the same length as x")
+
+        encoded = [str(name).encode("utf-8") for name in feature_names]
+        names = (ctypes.c_char_p * max(1, len(encoded)))(*encoded)
+        _check(self._lib.joinless_session_load(
+            self._handle,
+            _buffer(codes, ctypes.c_int32),
+            _buffer(x, ctypes.c_double),
+            _buffer(y, ctypes.c_double),
+            _buffer(numbers, ctypes.c_int64) if numbers is not None else None,
+            len(x),
+            names,
+            len(encoded),
+            _ORDERS[order],
+        ))
+        self._feature_names = [str(name) for name in feature_names]
+
+    def build_graph(self, distance: float):
+        """Build the star neighborhoods for a neighbor distance."""
+        _check(self._lib.joinless_session_build_graph(self._handle, float(distance)))
+
+    def mine(
+        self,
+        min_prevalence: float,
+        strategy: str = "levelwise",
+        memory_budget: int = 0,
+        spill_dir: Optional[str] = None,
+        participation: bool = True,
+    ) -> NativePatterns:
+        """Mine prevalent patterns over the current graph, with participation indexes."""
+        options = _Options()
+        self._lib.joinless_options_init(ctypes.byref(options))
+        options.min_prevalence = float(min_prevalence)
+        options.strategy = _STRATEGIES[strategy]
+        options.memory_budget = int(memory_budget)
+        options.spill_dir = spill_dir.encode("utf-8") if spill_dir else None
+        options.participation = 1 if participation else 0
+
+        result = ctypes.c_void_p()
+        _check(self._lib.joinless_session_mine(self._handle, ctypes.byref(options), ctypes.byref(result)))
+        try:
+            count = self._lib.joinless_result_count(result)
+            offsets = np.empty(count + 1, dtype=np.int64)
+            codes = np.empty(self._lib.joinless_result_total_features(result), dtype=np.int32)
+            indexes = np.empty(count, dtype=np.float64)
+            _check(self._lib.joinless_result_export(
+                result,
+                _buffer(offsets, ctypes.c_int64),
+                _buffer(codes, ctypes.c_int32),
+                _buffer(indexes, ctypes.c_double),
+            ))
+        finally:
+            self._lib.joinless_result_free(result)
+        return NativePatterns(offsets, codes, indexes, list(self._feature_names))
+
+
+# 4. HELPER FUNCTIONS
+def mine_arrays(
+    x: np.ndarray,
+    y: np.ndarray,
+    feature_codes: np.ndarray,
+    feature_names: Sequence[str],
+    distance: float,
+    min_prevalence: float,
+    order: str = "hilbert",
+) -> NativePatterns:
+    """One-shot mining of instances given as arrays."""
+    session = NativeSession()
+    session.load(x, y, feature_codes, feature_names, order=order)
+    session.build_graph(distance)
+    return session.mine(min_prevalence)
+
+
+def mine_dataframe(df, distance: float, min_prevalence: float, order: str = "hilbert") -> NativePatterns:
+    """
+    Mine a DataFrame with the dataset CSV columns (Feature, Instance, LocX, LocY).
+    Columns are passed as NumPy views; only the feature labels are factorized.
+    """
+    import pandas as pd
+
+    codes, names = pd.factorize(df["Feature"].astype(str))
+    session = NativeSession()
+    session.load(
+        df["LocX"].to_numpy(dtype=np.float64),
+        df["LocY"].to_numpy(dtype=np.float64),
+        codes.astype(np.int32),
+        list(names),
+        instance_numbers=df["Instance"].to_numpy(dtype=np.int64),
+        order=order,
+    )
+    session.build_graph(distance)
+    return session.mine(min_prevalence)
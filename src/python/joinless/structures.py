@@ -1,6 +1,7 @@
 from dataclasses import dataclass, field
 from typing import Dict, List, Set, Tuple, Optional
 import pickle
+import warnings
 
 # 1. INSTANCE DATA STRUCTURE
 @dataclass
@@ -134,6 +135,7 @@ class ColocationPattern:
     cliques: List[Clique] = field(
         default_factory=list
     )  # All cliques supporting this pattern
+    participation: Optional[float] = None  # Participation index computed by the native miner
 
     def __hash__(self):
         return hash(self.features)
@@ -188,9 +190,12 @@ class ColocationPattern:
         """
         Calculate participation index of the pattern.
         PI = min(participation_ratio(f) for f in features)
+        Patterns mined natively carry no cliques and return their mined index.
         """
         if not self.features:
             return 0.0
+        if not self.cliques and self.participation is not None:
+            return self.participation
 
         ratios = [self.participation_ratio(f, total_instances) for f in self.features]
         return min(ratios) if ratios else 0.0
@@ -229,7 +234,15 @@ class SpatialDataset:
         """
         Build neighbor relations based on distance threshold.
         This creates the spatial neighborhood graph.
+
+        Deprecated: compares every pair of instances (O(n^2)). The native miner
+        builds the neighbor graph itself; see mine_colocation_patterns().
         """
+        warnings.warn(
+            "build_neighbor_relations() is deprecated; the native miner builds the neighbor graph",
+            DeprecationWarning,
+            stacklevel=2,
+        )
         self.distance_threshold = threshold
         self.neighbor_relations.clear()
 
@@ -244,7 +257,14 @@ class SpatialDataset:
         """
         Build star neighborhoods for joinless algorithm.
         Each instance becomes a center with its neighbors.
+
+        Deprecated: the native miner builds the star neighborhoods itself.
         """
+        warnings.warn(
+            "build_star_neighborhoods() is deprecated; the native miner builds the star neighborhoods",
+            DeprecationWarning,
+            stacklevel=2,
+        )
         self.star_neighborhoods.clear()
 
         for instance in self.instances:
@@ -1,10 +1,12 @@
 import sys
 import os
 
+import pandas as pd
+
 # Add the current directory to sys.path to allow imports
 sys.path.append(os.path.dirname(os.path.abspath(__file__)))
 
-from joinless import load_or_build_dataset, mine_colocation_patterns
+from joinless import mine_dataframe
 
 def main():
     # Define paths relative to this script
@@ -12,20 +14,21 @@ def main():
     data_dir = os.path.join(base_dir, "data")
     
     csv_path = os.path.join(data_dir, "LasVegas_x_y_alphabet_version_03_2.csv")
-    cache_path = os.path.join(data_dir, "LasVegas_cache.pkl")
     distance_threshold = 160.0
+    min_prevalence = 0.5
 
     print(f"Data directory: {data_dir}")
     
-    # Load or build dataset
+    # Load the instances and mine them with the native miner
     try:
-        dataset = load_or_build_dataset(csv_path, cache_path, distance_threshold)
-        print(f"Successfully loaded dataset with {len(dataset.instances)} instances.")
+        df = pd.read_csv(csv_path)
+        print(f"Successfully loaded dataset with {len(df)} instances.")
         
-        # Run mining algorithm (Placeholder)
         print("Starting mining process...")
-        patterns = mine_colocation_patterns(dataset, min_prevalence=0.5)
-        print("Mining complete.")
+        result = mine_dataframe(df, distance_threshold, min_prevalence)
+        print(f"Mining complete. Patterns Found: {len(result)}")
+        for features, index in zip(result.patterns(), result.participation):
+            print(f"  {{{', '.join(features)}}} PI={index:.4f}")
         
     except FileNotFoundError:
         print(f"Error: Data file not found at {csv_path}")